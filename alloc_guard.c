@@ -0,0 +1,73 @@
+#include <errno.h>
+#include <stdatomic.h>
+#include <stddef.h>
+#include "alloc_guard.h"
+
+// glibc supports replacing malloc this way and routes its own internal
+// allocations through the replacement too
+extern void *__libc_malloc(size_t size);
+extern void *__libc_calloc(size_t nmemb, size_t size);
+extern void *__libc_realloc(void *ptr, size_t size);
+extern void *__libc_memalign(size_t alignment, size_t size);
+extern void __libc_free(void *ptr);
+
+static _Atomic int armed = 0;
+static _Atomic long allocs = 0;
+
+static inline void count_alloc(void) {
+    if (atomic_load_explicit(&armed, memory_order_relaxed)) {
+        atomic_fetch_add_explicit(&allocs, 1, memory_order_relaxed);
+    }
+}
+
+void *malloc(size_t size) {
+    count_alloc();
+    return __libc_malloc(size);
+}
+
+void *calloc(size_t nmemb, size_t size) {
+    count_alloc();
+    return __libc_calloc(nmemb, size);
+}
+
+void *realloc(void *ptr, size_t size) {
+    count_alloc();
+    return __libc_realloc(ptr, size);
+}
+
+void *memalign(size_t alignment, size_t size) {
+    count_alloc();
+    return __libc_memalign(alignment, size);
+}
+
+void *aligned_alloc(size_t alignment, size_t size) {
+    count_alloc();
+    return __libc_memalign(alignment, size);
+}
+
+int posix_memalign(void **memptr, size_t alignment, size_t size) {
+    count_alloc();
+    void *p = __libc_memalign(alignment, size);
+    if (!p) {
+        return ENOMEM;
+    }
+    *memptr = p;
+    return 0;
+}
+
+void free(void *ptr) {
+    __libc_free(ptr);
+}
+
+void alloc_guard_arm(void) {
+    atomic_store(&allocs, 0);
+    atomic_store(&armed, 1);
+}
+
+void alloc_guard_disarm(void) {
+    atomic_store(&armed, 0);
+}
+
+long alloc_guard_count(void) {
+    return atomic_load(&allocs);
+}
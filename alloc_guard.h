@@ -0,0 +1,13 @@
+#ifndef ALLOC_GUARD_H
+#define ALLOC_GUARD_H
+
+// Counts heap allocations (malloc/calloc/realloc and the aligned variants,
+// from any thread, including ones made inside libc) while armed. Used by
+// --alloc-check to fail the run if the steady-state scheduling path touches
+// the heap after warmup.
+
+void alloc_guard_arm(void);
+void alloc_guard_disarm(void);
+long alloc_guard_count(void);
+
+#endif
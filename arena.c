@@ -0,0 +1,164 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include "arena.h"
+
+#define ARENA_ALIGN 16
+
+static ArenaBlock *new_block(ArenaBlock *prev, size_t size) {
+    ArenaBlock *b = malloc(sizeof(ArenaBlock) + size);
+    if (!b) {
+        perror("Memory allocation failed");
+        exit(EXIT_FAILURE);
+    }
+    b->prev = prev;
+    b->size = size;
+    b->used = 0;
+    b->touched = 0;
+    return b;
+}
+
+static size_t live_bytes(const Arena *a) {
+    size_t live = 0;
+    for (ArenaBlock *b = a->block; b; b = b->prev) {
+        live += b->used;
+    }
+    return live;
+}
+
+static void note_high_water(Arena *a) {
+    size_t live = live_bytes(a);
+    if (live > a->highWater) {
+        a->highWater = live;
+    }
+}
+
+static void push_spare(Arena *a, ArenaBlock *b) {
+    b->used = 0;
+    b->prev = a->spare;
+    a->spare = b;
+}
+
+// smallest spare block that holds size, unlinked; NULL if none does
+static ArenaBlock *take_spare(Arena *a, size_t size) {
+    ArenaBlock **best = NULL;
+    for (ArenaBlock **link = &a->spare; *link; link = &(*link)->prev) {
+        if ((*link)->size >= size && (!best || (*link)->size < (*best)->size)) {
+            best = link;
+        }
+    }
+    if (!best) {
+        return NULL;
+    }
+    ArenaBlock *b = *best;
+    *best = b->prev;
+    return b;
+}
+
+void arena_init(Arena *a, size_t size) {
+    a->block = new_block(NULL, size);
+    a->spare = NULL;
+    a->capacity = size;
+    a->highWater = 0;
+}
+
+void *arena_alloc(Arena *a, size_t size) {
+    size = (size + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1);
+    ArenaBlock *b = a->block;
+    if (b->size - b->used < size) {
+        ArenaBlock *next = take_spare(a, size);
+        if (next) {
+            next->prev = b;
+        } else {
+            // grow geometrically so warmup needs only a few blocks
+            size_t grow = b->size * 2 > size ? b->size * 2 : size;
+            next = new_block(b, grow);
+            a->capacity += grow;
+        }
+        b = a->block = next;
+    }
+    void *p = b->data + b->used;
+    b->used += size;
+    if (b->used > b->touched) {
+        b->touched = b->used;
+    }
+    return p;
+}
+
+char *arena_strdup(Arena *a, const char *s) {
+    size_t len = strlen(s) + 1;
+    char *copy = arena_alloc(a, len);
+    memcpy(copy, s, len);
+    return copy;
+}
+
+ArenaMark arena_mark(const Arena *a) {
+    ArenaMark mark = { a->block, a->block->used };
+    return mark;
+}
+
+void arena_release(Arena *a, ArenaMark mark) {
+    note_high_water(a);
+    while (a->block != mark.block) {
+        ArenaBlock *b = a->block;
+        a->block = b->prev;
+        push_spare(a, b);
+    }
+    mark.block->used = mark.used;
+}
+
+// every block becomes a spare, then the largest comes back as current
+void arena_reset(Arena *a) {
+    note_high_water(a);
+    size_t largest = 0;
+    while (a->block) {
+        ArenaBlock *b = a->block;
+        a->block = b->prev;
+        push_spare(a, b);
+    }
+    for (ArenaBlock *b = a->spare; b; b = b->prev) {
+        largest = b->size > largest ? b->size : largest;
+    }
+    a->block = take_spare(a, largest);
+    a->block->prev = NULL;
+}
+
+static void trim_block(ArenaBlock *b, size_t keep) {
+    if (b->touched <= keep) {
+        return;
+    }
+    uintptr_t page = (uintptr_t)sysconf(_SC_PAGESIZE);
+    uintptr_t from = ((uintptr_t)b->data + keep + page - 1) & ~(page - 1);
+    uintptr_t to = ((uintptr_t)b->data + b->touched) & ~(page - 1);
+    if (to > from) {
+        madvise((void *)from, to - from, MADV_DONTNEED);
+    }
+    b->touched = keep;
+}
+
+void arena_trim(Arena *a, size_t keep) {
+    ArenaBlock *b = a->block;
+    trim_block(b, keep > b->used ? keep : b->used);
+    for (b = a->spare; b; b = b->prev) {
+        trim_block(b, 0);
+    }
+}
+
+static void free_chain(ArenaBlock *b) {
+    while (b) {
+        ArenaBlock *prev = b->prev;
+        free(b);
+        b = prev;
+    }
+}
+
+void arena_destroy(Arena *a) {
+    free_chain(a->block);
+    free_chain(a->spare);
+    a->block = NULL;
+    a->spare = NULL;
+    a->capacity = 0;
+}
@@ -0,0 +1,51 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stddef.h>
+
+// Bump allocator for per-timestep scratch (auth string tables, solver
+// results). Allocation is a pointer bump; nothing is freed individually.
+// When a block runs out the arena moves on to a spare block big enough, or
+// chains on a new one. Blocks are kept until arena_destroy: a reset makes
+// the largest one current and the rest spares, so once warmup has seen the
+// biggest timestep the arena never touches the heap, reset included.
+
+typedef struct ArenaBlock {
+    struct ArenaBlock *prev;
+    size_t size;
+    size_t used;
+    size_t touched;        // bytes written since the last trim
+    _Alignas(16) char data[];
+} ArenaBlock;
+
+typedef struct Arena {
+    ArenaBlock *block;     // current block, older ones in use chained via prev
+    ArenaBlock *spare;     // blocks not in use this timestep, chained via prev
+    size_t capacity;       // sum of all block sizes, spares included
+    size_t highWater;      // most bytes live at once since init
+} Arena;
+
+typedef struct ArenaMark {
+    ArenaBlock *block;
+    size_t used;
+} ArenaMark;
+
+void arena_init(Arena *a, size_t size);
+void *arena_alloc(Arena *a, size_t size);
+char *arena_strdup(Arena *a, const char *s);
+
+// drop everything allocated since the mark
+ArenaMark arena_mark(const Arena *a);
+void arena_release(Arena *a, ArenaMark mark);
+
+// drop everything; called once per timestep
+void arena_reset(Arena *a);
+
+// give the current block's pages above keep (and above what is live), and
+// every page of the spare blocks, back to the kernel. The blocks stay
+// allocated, so this never touches the heap; the pages fault back in zeroed
+// if a later timestep needs them again.
+void arena_trim(Arena *a, size_t keep);
+void arena_destroy(Arena *a);
+
+#endif
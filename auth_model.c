@@ -0,0 +1,316 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "auth_model.h"
+
+static const char validChars[] = "56789.";
+
+static int char_index(char c) {
+    const char *p = strchr(validChars, c);
+    return (p && c != '\0') ? (int)(p - validChars) : -1;
+}
+
+void auth_model_record(AuthModel *am, int dockId, const char *auth) {
+    int length = strlen(auth);
+    if (length < 1 || length > AUTH_MODEL_MAX_LEN || dockId < 0 || dockId >= AUTH_MODEL_DOCKS) {
+        return;
+    }
+    for (int pos = 0; pos < length; pos++) {
+        int c = char_index(auth[pos]);
+        if (c == -1) {
+            return;
+        }
+    }
+    for (int pos = 0; pos < length; pos++) {
+        int c = char_index(auth[pos]);
+        am->lenCount[length][pos][c]++;
+        am->dockCount[dockId][length][pos][c]++;
+    }
+    am->samples[length]++;
+}
+
+int auth_model_load(AuthModel *am, const char *path) {
+    FILE *fp = fopen(path, "r");
+    if (fp == NULL) {
+        return -1;
+    }
+    int dockId, entries = 0;
+    char auth[128];
+    while (fscanf(fp, "%d %127s", &dockId, auth) == 2) {
+        auth_model_record(am, dockId, auth);
+        entries++;
+    }
+    fclose(fp);
+    return entries;
+}
+
+// the stdio buffer is static so appending never touches the heap
+FILE *auth_model_open_log(const char *path) {
+    static char logBuf[BUFSIZ];
+    FILE *fp = fopen(path, "a");
+    if (fp != NULL) {
+        setvbuf(fp, logBuf, _IOLBF, sizeof(logBuf));
+    }
+    return fp;
+}
+
+int auth_model_append(FILE *fp, int dockId, const char *auth) {
+    if (fprintf(fp, "%d %s\n", dockId, auth) < 0) {
+        return -1;
+    }
+    return 0;
+}
+
+long long auth_space_size(int length) {
+    long long total = 5;
+    for (int i = 1; i < length - 1; i++) {
+        total *= 6;
+    }
+    if (length > 1) {
+        total *= 5;
+    }
+    return total;
+}
+
+// plain enumeration order: first char is the least significant digit (base 5), the
+// middle ones base 6, the last char the most significant (base 5)
+long long auth_plain_index(const char *auth) {
+    int length = strlen(auth);
+    if (length == 1) {
+        return char_index(auth[0]);
+    }
+    long long idx = char_index(auth[length - 1]);
+    for (int pos = length - 2; pos >= 1; pos--) {
+        idx = idx * 6 + char_index(auth[pos]);
+    }
+    return idx * 5 + char_index(auth[0]);
+}
+
+// log-likelihood table: dock history counts double, Laplace smoothed.
+// Fixed point, so a candidate's score is an exact integer sum: ties are
+// real ties and the search bounds below are exact.
+static void build_scores(const AuthModel *am, int dockId, int length, long long score[][AUTH_ALPHABET]) {
+    for (int pos = 0; pos < length; pos++) {
+        int alphabet = (pos == 0 || pos == length - 1) ? 5 : 6;
+        double weight[AUTH_ALPHABET], sum = 0;
+        for (int c = 0; c < alphabet; c++) {
+            weight[c] = 1.0 + am->lenCount[length][pos][c];
+            if (dockId >= 0 && dockId < AUTH_MODEL_DOCKS) {
+                weight[c] += 2.0 * am->dockCount[dockId][length][pos][c];
+            }
+            sum += weight[c];
+        }
+        for (int c = 0; c < alphabet; c++) {
+            score[pos][c] = llround(log(weight[c] / sum) * AUTH_SCORE_ONE);
+        }
+    }
+}
+
+static int radix(int length, int pos) {
+    return (pos == 0 || pos == length - 1) ? 5 : 6;
+}
+
+// character of candidate idx at pos, plain order's digits
+static int digit_at(int length, long long idx, int pos) {
+    if (pos > 0) {
+        idx /= 5;
+    }
+    for (int p = 1; p < pos && p < length - 1; p++) {
+        idx /= 6;
+    }
+    return (int)(idx % radix(length, pos));
+}
+
+long long auth_model_score(const AuthModel *am, int dockId, int length, long long idx) {
+    long long score[AUTH_MODEL_MAX_LEN][AUTH_ALPHABET];
+    if (length < 1 || length > AUTH_MODEL_MAX_LEN) {
+        return 0;
+    }
+    build_scores(am, dockId, length, score);
+    long long s = 0;
+    for (int pos = 0; pos < length; pos++) {
+        s += score[pos][digit_at(length, idx, pos)];
+    }
+    return s;
+}
+
+typedef struct Candidate {
+    long long score;
+    long long idx;
+} Candidate;
+
+// true if a ranks after b
+static int worse(const Candidate *a, const Candidate *b) {
+    return a->score < b->score || (a->score == b->score && a->idx > b->idx);
+}
+
+static void sift_down(Candidate *heap, int size, int i) {
+    for (;;) {
+        int w = i, l = 2 * i + 1, r = 2 * i + 2;
+        if (l < size && worse(&heap[l], &heap[w])) w = l;
+        if (r < size && worse(&heap[r], &heap[w])) w = r;
+        if (w == i) return;
+        Candidate tmp = heap[i];
+        heap[i] = heap[w];
+        heap[w] = tmp;
+        i = w;
+    }
+}
+
+// keep the k best in a min-heap (worst at the root)
+static void offer(Candidate *heap, int *size, int k, Candidate c) {
+    if (*size < k) {
+        int i = (*size)++;
+        heap[i] = c;
+        while (i > 0 && worse(&heap[i], &heap[(i - 1) / 2])) {
+            Candidate tmp = heap[i];
+            heap[i] = heap[(i - 1) / 2];
+            heap[(i - 1) / 2] = tmp;
+            i = (i - 1) / 2;
+        }
+    } else if (worse(&heap[0], &c)) {
+        heap[0] = c;
+        sift_down(heap, *size, 0);
+    }
+}
+
+// Best-first branch and bound over the positions, most significant digit
+// (the last char) first, so a subtree is one contiguous index range. Each level tries its characters
+// best first, so the heap fills with good candidates right away. A subtree
+// is cut when even its best completion (prefix score plus the best
+// character at every remaining position) can't beat the worst of the k
+// kept, or only ties it from a higher index. The work grows with k and the
+// length rather than with the 5*6^(length-2)*5 candidate space.
+typedef struct TopSearch {
+    int length, k, size;
+    int order[AUTH_MODEL_MAX_LEN];                 // positions, most significant (last) first
+    int byScore[AUTH_MODEL_MAX_LEN][AUTH_ALPHABET]; // characters of each position, best first
+    long long score[AUTH_MODEL_MAX_LEN][AUTH_ALPHABET];
+    long long bestRest[AUTH_MODEL_MAX_LEN + 1];    // best score of order[d..]
+    long long span[AUTH_MODEL_MAX_LEN + 1];        // candidates under one node at depth d
+    Candidate *heap;
+} TopSearch;
+
+static void top_search(TopSearch *ts, int depth, long long prefixScore, long long prefixIdx) {
+    if (ts->size == ts->k) {
+        long long bound = prefixScore + ts->bestRest[depth];
+        const Candidate *worst = &ts->heap[0];
+        if (bound < worst->score || (bound == worst->score && prefixIdx * ts->span[depth] > worst->idx)) {
+            return;
+        }
+    }
+    if (depth == ts->length) {
+        offer(ts->heap, &ts->size, ts->k, (Candidate){ prefixScore, prefixIdx });
+        return;
+    }
+    int pos = ts->order[depth];
+    int alphabet = radix(ts->length, pos);
+    for (int i = 0; i < alphabet; i++) {
+        int c = ts->byScore[pos][i];
+        top_search(ts, depth + 1, prefixScore + ts->score[pos][c], prefixIdx * alphabet + c);
+    }
+}
+
+int auth_model_top(const AuthModel *am, int dockId, int length, long long *top, int limit) {
+    if (length < 1 || length > AUTH_MODEL_MAX_LEN || am->samples[length] == 0 || limit <= 0) {
+        return 0;
+    }
+    TopSearch ts;
+    Candidate heap[AUTH_PROBE_LIMIT];
+    build_scores(am, dockId, length, ts.score);
+
+    long long total = auth_space_size(length);
+    if (limit > AUTH_PROBE_LIMIT) {
+        limit = AUTH_PROBE_LIMIT;
+    }
+    ts.length = length;
+    ts.k = total < limit ? (int)total : limit;
+    ts.size = 0;
+    ts.heap = heap;
+    for (int d = 0; d < length; d++) {
+        ts.order[d] = length - 1 - d;
+    }
+    for (int pos = 0; pos < length; pos++) {
+        // insertion sort, best score first, lower character on ties
+        int alphabet = radix(length, pos);
+        for (int c = 0; c < alphabet; c++) {
+            int i = c;
+            while (i > 0 && ts.score[pos][ts.byScore[pos][i - 1]] < ts.score[pos][c]) {
+                ts.byScore[pos][i] = ts.byScore[pos][i - 1];
+                i--;
+            }
+            ts.byScore[pos][i] = c;
+        }
+    }
+    ts.bestRest[length] = 0;
+    ts.span[length] = 1;
+    for (int d = length - 1; d >= 0; d--) {
+        int pos = ts.order[d];
+        ts.bestRest[d] = ts.bestRest[d + 1] + ts.score[pos][ts.byScore[pos][0]];
+        ts.span[d] = ts.span[d + 1] * radix(length, pos);
+    }
+    top_search(&ts, 0, 0, 0);
+
+    // pop worst first, filling from the back
+    int size = ts.size;
+    for (int i = size - 1; i >= 0; i--) {
+        top[i] = heap[0].idx;
+        heap[0] = heap[--size];
+        sift_down(heap, size, 0);
+    }
+    return ts.k;
+}
+
+static void sift_index(long long *v, int count, int i) {
+    for (int c; (c = 2 * i + 1) < count; i = c) {
+        if (c + 1 < count && v[c + 1] > v[c]) c++;
+        if (v[i] >= v[c]) return;
+        long long tmp = v[i];
+        v[i] = v[c];
+        v[c] = tmp;
+    }
+}
+
+// in-place heapsort; qsort may allocate a scratch buffer
+static void sort_indices(long long *v, int count) {
+    for (int i = count / 2 - 1; i >= 0; i--) {
+        sift_index(v, count, i);
+    }
+    for (int end = count - 1; end > 0; end--) {
+        long long tmp = v[0];
+        v[0] = v[end];
+        v[end] = tmp;
+        sift_index(v, end, 0);
+    }
+}
+
+void auth_order_init(AuthOrder *o, const AuthModel *am, int dockId, int length) {
+    o->total = auth_space_size(length);
+    o->numTop = am ? auth_model_top(am, dockId, length, o->top, AUTH_PROBE_LIMIT) : 0;
+    memcpy(o->picked, o->top, o->numTop * sizeof(long long));
+    sort_indices(o->picked, o->numTop);
+}
+
+// Past the likely ones, position pos is the r-th candidate not among them:
+// r plus however many of them come at or before it. picked is ascending
+// and so are the positions a caller asks for, so that count only grows.
+long long auth_order_at(const AuthOrder *o, long long pos, int *skipped) {
+    if (pos < o->numTop) {
+        return o->top[pos];
+    }
+    long long r = pos - o->numTop;
+    while (*skipped < o->numTop && o->picked[*skipped] <= r + *skipped) {
+        (*skipped)++;
+    }
+    return r + *skipped;
+}
+
+void auth_plain_string(int length, long long idx, char *out) {
+    for (int pos = 0; pos < length; pos++) {
+        int base = radix(length, pos);
+        out[pos] = validChars[idx % base];
+        idx /= base;
+    }
+    out[length] = '\0';
+}
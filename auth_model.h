@@ -0,0 +1,68 @@
+#ifndef AUTH_MODEL_H
+#define AUTH_MODEL_H
+
+#include <stdio.h>
+
+// Learned auth string likelihoods for the optional learning mode.
+// Every accepted auth string is counted per (length, position, character)
+// and per dock; candidates are then scored by their per-position character
+// frequencies and the most likely ones probed before the rest in plain
+// enumeration order. The history file is one "dockId authString" line per
+// accepted string, so it is both the saved model and a replayable trace.
+
+#define AUTH_MODEL_MAX_LEN 16     // longer strings are far too many to enumerate anyway
+#define AUTH_MODEL_DOCKS 30       // MAX_DOCKS
+#define AUTH_ALPHABET 6           // "56789."
+#define AUTH_PROBE_LIMIT 4096     // likely candidates tried before plain order
+#define AUTH_SCORE_ONE (1LL << 40) // fixed-point scale of candidate log-likelihoods
+
+typedef struct AuthModel {
+    int lenCount[AUTH_MODEL_MAX_LEN + 1][AUTH_MODEL_MAX_LEN][AUTH_ALPHABET];
+    int dockCount[AUTH_MODEL_DOCKS][AUTH_MODEL_MAX_LEN + 1][AUTH_MODEL_MAX_LEN][AUTH_ALPHABET];
+    int samples[AUTH_MODEL_MAX_LEN + 1];
+} AuthModel;
+
+void auth_model_record(AuthModel *am, int dockId, const char *auth);
+
+// replay a history file into the model; returns entries read, -1 if missing
+int auth_model_load(AuthModel *am, const char *path);
+FILE *auth_model_open_log(const char *path);
+int auth_model_append(FILE *fp, int dockId, const char *auth);
+
+// number of candidate strings of length
+long long auth_space_size(int length);
+
+// index of auth in plain enumeration order
+long long auth_plain_index(const char *auth);
+
+// Fill top[] with up to limit candidate indices (plain order) in
+// decreasing likelihood, ties by index. Returns 0 when nothing has been
+// learned for this length yet. Searches for them directly instead of
+// scoring the whole space, so it costs about the same at any length.
+int auth_model_top(const AuthModel *am, int dockId, int length, long long *top, int limit);
+
+// log-likelihood of candidate idx, times AUTH_SCORE_ONE; what auth_model_top ranks by
+long long auth_model_score(const AuthModel *am, int dockId, int length, long long idx);
+
+// candidate idx in plain order, written to out (length + 1 bytes)
+void auth_plain_string(int length, long long idx, char *out);
+
+// A search order over the candidates that needs no table of them: the
+// model's likely ones first, the rest in plain order. Workers map their
+// positions to candidate indices, so a search allocates nothing at any
+// length.
+typedef struct AuthOrder {
+    long long total;
+    int numTop;
+    long long top[AUTH_PROBE_LIMIT];      // probed first, most likely first
+    long long picked[AUTH_PROBE_LIMIT];   // the same, ascending
+} AuthOrder;
+
+// am NULL (or nothing learned for the length) gives plain order
+void auth_order_init(AuthOrder *o, const AuthModel *am, int dockId, int length);
+
+// candidate index at position pos; *skipped starts at 0 and carries over
+// between calls, which must come in increasing pos
+long long auth_order_at(const AuthOrder *o, long long pos, int *skipped);
+
+#endif
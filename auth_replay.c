@@ -0,0 +1,84 @@
+// Replays a learning-mode history file (see auth_model.h) and reports how
+// many guesses each accepted auth string needed in plain enumeration
+// order versus the learned order, training the model only on the entries
+// before it. Counts are for one solver probing sequentially.
+//
+// build: gcc -O2 -o auth_replay auth_replay.c auth_model.c -lm
+// usage: ./auth_replay <history_file>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "auth_model.h"
+
+static AuthModel model;
+static long long top[AUTH_PROBE_LIMIT];
+
+// 1-based position of idx in the learned order
+static long long learned_rank(int dockId, int length, long long idx) {
+    int k = auth_model_top(&model, dockId, length, top, AUTH_PROBE_LIMIT);
+    long long before = 0;
+    for (int i = 0; i < k; i++) {
+        if (top[i] == idx) {
+            return i + 1;
+        }
+        if (top[i] < idx) {
+            before++;
+        }
+    }
+    return k + (idx - before) + 1;
+}
+
+int main(int argc, char *argv[]) {
+    if (argc != 2) {
+        fprintf(stderr, "usage: %s <history_file>\n", argv[0]);
+        exit(EXIT_FAILURE);
+    }
+    FILE *fp = fopen(argv[1], "r");
+    if (fp == NULL) {
+        perror("error opening history file");
+        exit(EXIT_FAILURE);
+    }
+
+    long long plainSum[AUTH_MODEL_MAX_LEN + 1] = {0};
+    long long learnedSum[AUTH_MODEL_MAX_LEN + 1] = {0};
+    int count[AUTH_MODEL_MAX_LEN + 1] = {0};
+    int dockId, skipped = 0;
+    char auth[128];
+
+    while (fscanf(fp, "%d %127s", &dockId, auth) == 2) {
+        int length = strlen(auth);
+        if (length > AUTH_MODEL_MAX_LEN || dockId < 0 || dockId >= AUTH_MODEL_DOCKS) {
+            skipped++;
+            continue;
+        }
+        long long idx = auth_plain_index(auth);
+        plainSum[length] += idx + 1;
+        learnedSum[length] += learned_rank(dockId, length, idx);
+        count[length]++;
+        auth_model_record(&model, dockId, auth);
+    }
+    fclose(fp);
+
+    long long plainTotal = 0, learnedTotal = 0;
+    printf("len | searches | space       | plain avg    | learned avg  | speedup\n");
+    for (int length = 1; length <= AUTH_MODEL_MAX_LEN; length++) {
+        if (count[length] == 0) {
+            continue;
+        }
+        plainTotal += plainSum[length];
+        learnedTotal += learnedSum[length];
+        printf("%3d | %8d | %11lld | %12.1f | %12.1f | %6.2fx\n", length, count[length],
+               auth_space_size(length), (double)plainSum[length] / count[length],
+               (double)learnedSum[length] / count[length],
+               (double)plainSum[length] / learnedSum[length]);
+    }
+    printf("total guesses: plain %lld, learned %lld", plainTotal, learnedTotal);
+    if (learnedTotal > 0) {
+        printf(" (%.2fx)", (double)plainTotal / learnedTotal);
+    }
+    printf("\n");
+    if (skipped) {
+        printf("%d entries skipped (length > %d or bad dock)\n", skipped, AUTH_MODEL_MAX_LEN);
+    }
+    return 0;
+}
@@ -0,0 +1,217 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <errno.h>
+#include <sched.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include "cpu_topology.h"
+
+#define MPOL_PREFERRED 1          // <numaif.h>, not worth a libnuma dependency
+
+static int read_int(const char *path, int fallback) {
+    FILE *fp = fopen(path, "r");
+    int value;
+    if (fp == NULL) {
+        return fallback;
+    }
+    if (fscanf(fp, "%d", &value) != 1) {
+        value = fallback;
+    }
+    fclose(fp);
+    return value;
+}
+
+int parse_cpu_list(const char *s, int *cpus, int max) {
+    int count = 0;
+    while (*s && *s != '\n') {
+        char *end;
+        long first = strtol(s, &end, 10);
+        long last = first;
+        if (end == s || first < 0) {
+            return -1;
+        }
+        if (*end == '-') {
+            s = end + 1;
+            last = strtol(s, &end, 10);
+            if (end == s || last < first) {
+                return -1;
+            }
+        }
+        for (long cpu = first; cpu <= last && count < max; cpu++) {
+            cpus[count++] = (int)cpu;
+        }
+        s = end;
+        if (*s == ',') {
+            s++;
+        } else if (*s && *s != '\n') {
+            return -1;
+        }
+    }
+    return count;
+}
+
+// node directories list their cpus; cpus missing from all of them stay on 0
+static void load_nodes(CpuTopology *topo) {
+    static int nodeCpus[TOPO_MAX_CPUS];
+    topo->numNodes = 1;
+    for (int node = 0; node < TOPO_MAX_CPUS; node++) {
+        char path[96], list[4096];
+        snprintf(path, sizeof(path), "/sys/devices/system/node/node%d/cpulist", node);
+        FILE *fp = fopen(path, "r");
+        if (fp == NULL) {
+            if (node > 0) {
+                break;
+            }
+            continue;
+        }
+        int n = fgets(list, sizeof(list), fp) ? parse_cpu_list(list, nodeCpus, TOPO_MAX_CPUS) : -1;
+        fclose(fp);
+        for (int i = 0; i < n; i++) {
+            for (int j = 0; j < topo->numCpus; j++) {
+                if (topo->cpus[j].cpu == nodeCpus[i]) {
+                    topo->cpus[j].node = node;
+                }
+            }
+        }
+        topo->numNodes = node + 1;
+    }
+}
+
+int topology_load(CpuTopology *topo) {
+    static int online[TOPO_MAX_CPUS];
+    char list[4096];
+    int count = -1;
+    FILE *fp = fopen("/sys/devices/system/cpu/online", "r");
+    if (fp != NULL) {
+        if (fgets(list, sizeof(list), fp)) {
+            count = parse_cpu_list(list, online, TOPO_MAX_CPUS);
+        }
+        fclose(fp);
+    }
+
+    cpu_set_t allowed;
+    CPU_ZERO(&allowed);
+    if (sched_getaffinity(0, sizeof(allowed), &allowed) == -1) {
+        return -1;
+    }
+    if (count <= 0) {
+        // no sysfs: fall back to the affinity mask alone
+        count = 0;
+        for (int cpu = 0; cpu < CPU_SETSIZE && count < TOPO_MAX_CPUS; cpu++) {
+            if (CPU_ISSET(cpu, &allowed)) {
+                online[count++] = cpu;
+            }
+        }
+    }
+
+    topo->numCpus = 0;
+    for (int i = 0; i < count; i++) {
+        int cpu = online[i];
+        if (cpu >= CPU_SETSIZE || !CPU_ISSET(cpu, &allowed)) {
+            continue;
+        }
+        char path[96];
+        CpuInfo *info = &topo->cpus[topo->numCpus++];
+        info->cpu = cpu;
+        snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d/topology/physical_package_id", cpu);
+        info->package = read_int(path, 0);
+        snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d/topology/core_id", cpu);
+        info->core = read_int(path, cpu);
+        info->node = 0;
+    }
+    if (topo->numCpus == 0) {
+        return -1;
+    }
+    load_nodes(topo);
+    return topo->numCpus;
+}
+
+int topology_node_of(const CpuTopology *topo, int cpu) {
+    for (int i = 0; i < topo->numCpus; i++) {
+        if (topo->cpus[i].cpu == cpu) {
+            return topo->cpus[i].node;
+        }
+    }
+    return 0;
+}
+
+static bool core_in_use(const CpuTopology *topo, const char *used, const CpuInfo *c) {
+    for (int j = 0; j < topo->numCpus; j++) {
+        if (used[j] && topo->cpus[j].package == c->package && topo->cpus[j].core == c->core) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Order every other cpu by preference relative to the main loop's cpu: same
+// node first, and within a node one cpu per idle physical core before the
+// hyperthread siblings, by cpu number.
+void topology_plan(const CpuTopology *topo, int *plan, int count) {
+    static int order[TOPO_MAX_CPUS];
+    static char used[TOPO_MAX_CPUS];
+    if (count <= 0 || topo->numCpus == 0) {
+        return;
+    }
+    const CpuInfo *main = &topo->cpus[0];
+    int n = 0;
+    memset(used, 0, sizeof(used));
+    used[0] = 1;
+    for (int pass = 0; pass < 4; pass++) {
+        bool sameNode = pass < 2;
+        bool wholeCore = pass % 2 == 0;
+        for (int i = 1; i < topo->numCpus; i++) {
+            const CpuInfo *c = &topo->cpus[i];
+            if (used[i] || (c->node == main->node) != sameNode) {
+                continue;
+            }
+            if (wholeCore && core_in_use(topo, used, c)) {
+                continue;
+            }
+            used[i] = 1;
+            order[n++] = c->cpu;
+        }
+    }
+
+    plan[0] = main->cpu;
+    for (int i = 1; i < count; i++) {
+        plan[i] = n > 0 ? order[(i - 1) % n] : main->cpu;
+    }
+}
+
+int pin_thread(pthread_t thread, int cpu) {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return pthread_setaffinity_np(thread, sizeof(set), &set);
+}
+
+int pin_attr(pthread_attr_t *attr, int cpu) {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return pthread_attr_setaffinity_np(attr, sizeof(set), &set);
+}
+
+int pinned_to(pthread_t thread, int cpu) {
+    cpu_set_t set;
+    if (pthread_getaffinity_np(thread, sizeof(set), &set) != 0) {
+        return -1;
+    }
+    return CPU_COUNT(&set) == 1 && CPU_ISSET(cpu, &set);
+}
+
+int bind_to_node(const CpuTopology *topo, void *addr, size_t len, int node) {
+    if (topo->numNodes <= 1) {
+        return 0;
+    }
+    unsigned long mask[TOPO_MAX_CPUS / (8 * sizeof(unsigned long))] = {0};
+    mask[node / (8 * sizeof(unsigned long))] |= 1UL << (node % (8 * sizeof(unsigned long)));
+    if (syscall(SYS_mbind, addr, len, MPOL_PREFERRED, mask, (unsigned long)TOPO_MAX_CPUS, 0) == -1) {
+        return errno;
+    }
+    return 0;
+}
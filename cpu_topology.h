@@ -0,0 +1,53 @@
+#ifndef CPU_TOPOLOGY_H
+#define CPU_TOPOLOGY_H
+
+#include <pthread.h>
+#include <stddef.h>
+
+// CPU layout read from sysfs (/sys/devices/system/cpu and /sys/devices/system/node),
+// used by --pin to place the scheduler's main loop and solver queue workers.
+// Only cpus that are online and in the process's affinity mask are listed.
+// Without a node directory every cpu is on node 0.
+
+#define TOPO_MAX_CPUS 1024
+
+typedef struct CpuInfo {
+    int cpu;
+    int package;        // physical_package_id, the socket
+    int core;           // core_id, unique within a package
+    int node;           // NUMA node
+} CpuInfo;
+
+typedef struct CpuTopology {
+    CpuInfo cpus[TOPO_MAX_CPUS];
+    int numCpus;
+    int numNodes;
+} CpuTopology;
+
+// returns the number of usable cpus, -1 if none could be read
+int topology_load(CpuTopology *topo);
+
+// "0-3,8,10-11" -> cpu ids; returns the count, -1 on a malformed list
+int parse_cpu_list(const char *s, int *cpus, int max);
+
+// Fill plan[0..count) with cpus: plan[0] for the main loop, the rest for
+// workers. Workers stay on the main loop's node and get a physical core of
+// their own before any hyperthread sibling is used; other nodes come last
+// and the list wraps when there are more workers than cpus.
+void topology_plan(const CpuTopology *topo, int *plan, int count);
+
+int topology_node_of(const CpuTopology *topo, int cpu);
+
+// 0 or an errno value, like pthread_setaffinity_np
+int pin_thread(pthread_t thread, int cpu);
+int pin_attr(pthread_attr_t *attr, int cpu);
+
+// 1 if the thread's affinity is exactly cpu, 0 if not, -1 if it can't be read
+int pinned_to(pthread_t thread, int cpu);
+
+// Prefer node for the pages of [addr, addr + len) that are not faulted in
+// yet (first touch would otherwise decide). Needs page-aligned addr; a
+// no-op on single-node hosts.
+int bind_to_node(const CpuTopology *topo, void *addr, size_t len, int node);
+
+#endif
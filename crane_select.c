@@ -0,0 +1,137 @@
+#include <stdbool.h>
+#include <limits.h>
+#include "crane_select.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+void crane_set_reset(CraneSet *cs, int numCranes) {
+    for (int i = 0; i < CRANE_LANES; i++) {
+        cs->usable[i] = i < numCranes ? -1 : 0;
+    }
+}
+
+int crane_select_scalar(const CraneSet *cs, int weight) {
+    int bestCraneIdx = -1;
+    int minWaste = INT_MAX;
+    for (int i = 0; i < CRANE_LANES; i++) {
+        if (cs->usable[i] && cs->capacity[i] >= weight) {
+            int waste = cs->capacity[i] - weight;
+            if (waste < minWaste) {
+                minWaste = waste;
+                bestCraneIdx = i;
+            }
+        }
+    }
+    return bestCraneIdx;
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+
+// For a fixed weight the smallest waste is the smallest eligible capacity,
+// so both kernels take a masked min of capacities, then the first eligible
+// lane holding it. Ineligible lanes read as INT_MAX, and the eligible mask
+// (not the min value) decides whether anything fits. That matches the old
+// scan for every weight of at least 1, which cargo weights are: there a
+// crane of capacity INT_MAX wastes less than INT_MAX and the scan takes it
+// too. Below 1 they differ (the scan's waste reaches INT_MAX or overflows).
+
+__attribute__((target("sse4.1")))
+int crane_select_sse4(const CraneSet *cs, int weight) {
+    const __m128i w = _mm_set1_epi32(weight - 1);
+    const __m128i inf = _mm_set1_epi32(INT_MAX);
+    __m128i elig[CRANE_LANES / 4];
+    __m128i key[CRANE_LANES / 4];
+    __m128i best = inf;
+    int any = 0;
+
+    for (int v = 0; v < CRANE_LANES / 4; v++) {
+        __m128i cap = _mm_load_si128((const __m128i *)&cs->capacity[v * 4]);
+        __m128i use = _mm_load_si128((const __m128i *)&cs->usable[v * 4]);
+        elig[v] = _mm_and_si128(use, _mm_cmpgt_epi32(cap, w));
+        key[v] = _mm_blendv_epi8(inf, cap, elig[v]);
+        best = _mm_min_epi32(best, key[v]);
+        any |= _mm_movemask_ps(_mm_castsi128_ps(elig[v]));
+    }
+    if (!any) {
+        return -1;
+    }
+
+    best = _mm_min_epi32(best, _mm_shuffle_epi32(best, _MM_SHUFFLE(1, 0, 3, 2)));
+    best = _mm_min_epi32(best, _mm_shuffle_epi32(best, _MM_SHUFFLE(2, 3, 0, 1)));
+
+    for (int v = 0; v < CRANE_LANES / 4; v++) {
+        __m128i hit = _mm_and_si128(elig[v], _mm_cmpeq_epi32(key[v], best));
+        int bits = _mm_movemask_ps(_mm_castsi128_ps(hit));
+        if (bits) {
+            return v * 4 + __builtin_ctz(bits);
+        }
+    }
+    return -1;
+}
+
+__attribute__((target("avx2")))
+int crane_select_avx2(const CraneSet *cs, int weight) {
+    const __m256i w = _mm256_set1_epi32(weight - 1);
+    const __m256i inf = _mm256_set1_epi32(INT_MAX);
+    __m256i elig[CRANE_LANES / 8];
+    __m256i key[CRANE_LANES / 8];
+    __m256i best = inf;
+    int any = 0;
+
+    for (int v = 0; v < CRANE_LANES / 8; v++) {
+        __m256i cap = _mm256_load_si256((const __m256i *)&cs->capacity[v * 8]);
+        __m256i use = _mm256_load_si256((const __m256i *)&cs->usable[v * 8]);
+        elig[v] = _mm256_and_si256(use, _mm256_cmpgt_epi32(cap, w));
+        key[v] = _mm256_blendv_epi8(inf, cap, elig[v]);
+        best = _mm256_min_epi32(best, key[v]);
+        any |= _mm256_movemask_ps(_mm256_castsi256_ps(elig[v]));
+    }
+    if (!any) {
+        return -1;
+    }
+
+    __m128i b = _mm_min_epi32(_mm256_castsi256_si128(best), _mm256_extracti128_si256(best, 1));
+    b = _mm_min_epi32(b, _mm_shuffle_epi32(b, _MM_SHUFFLE(1, 0, 3, 2)));
+    b = _mm_min_epi32(b, _mm_shuffle_epi32(b, _MM_SHUFFLE(2, 3, 0, 1)));
+    best = _mm256_broadcastd_epi32(b);
+
+    for (int v = 0; v < CRANE_LANES / 8; v++) {
+        __m256i hit = _mm256_and_si256(elig[v], _mm256_cmpeq_epi32(key[v], best));
+        int bits = _mm256_movemask_ps(_mm256_castsi256_ps(hit));
+        if (bits) {
+            return v * 8 + __builtin_ctz(bits);
+        }
+    }
+    return -1;
+}
+
+#endif
+
+static int (*select_impl)(const CraneSet *, int) = crane_select_scalar;
+static const char *select_name = "scalar";
+
+// Runs before main, so the kernel is fixed before any port worker can call
+// in and the pointer is only ever read afterwards.
+__attribute__((constructor))
+static void pick_impl() {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        select_impl = crane_select_avx2;
+        select_name = "avx2";
+    } else if (__builtin_cpu_supports("sse4.1")) {
+        select_impl = crane_select_sse4;
+        select_name = "sse4.1";
+    }
+#endif
+}
+
+int crane_select_best(const CraneSet *cs, int weight) {
+    return select_impl(cs, weight);
+}
+
+const char *crane_select_name() {
+    return select_name;
+}
@@ -0,0 +1,41 @@
+#ifndef CRANE_SELECT_H
+#define CRANE_SELECT_H
+
+#include <stdbool.h>
+
+// Best-fit crane selection: among free cranes with capacity >= weight pick
+// the one with the least waste, lowest index on ties. Same result as the
+// scalar scan load_cargo/unload_cargo used to do, but over an aligned,
+// padded lane array so it vectorizes. The SSE4.1/AVX2 kernel is chosen at
+// runtime; other targets use the scalar one.
+
+#define CRANE_LANES 32   // MAX_CATEGORY rounded up to a multiple of 8
+
+typedef struct CraneSet {
+    _Alignas(32) int capacity[CRANE_LANES];
+    _Alignas(32) int usable[CRANE_LANES];   // -1 free crane, 0 used or padding
+} CraneSet;
+
+// mark cranes [0, numCranes) free and the padding lanes unusable
+void crane_set_reset(CraneSet *cs, int numCranes);
+
+static inline void crane_set_use(CraneSet *cs, int idx) {
+    cs->usable[idx] = 0;
+}
+
+static inline bool crane_set_is_used(const CraneSet *cs, int idx) {
+    return cs->usable[idx] == 0;
+}
+
+// index of the best crane for weight (at least 1), or -1 if none fits
+int crane_select_best(const CraneSet *cs, int weight);
+
+int crane_select_scalar(const CraneSet *cs, int weight);
+#if defined(__x86_64__) || defined(__i386__)
+int crane_select_sse4(const CraneSet *cs, int weight);
+int crane_select_avx2(const CraneSet *cs, int weight);
+#endif
+
+const char *crane_select_name();
+
+#endif
@@ -0,0 +1,142 @@
+// Round-trip latency and one-way throughput of the IPC backends.
+// A forked child plays the solver: it answers every SolverRequest with a
+// SolverResponse, the same exchange authStringThreadFunc does per guess.
+//
+// build: gcc -O2 -o ipc_bench ipc_bench.c ipc_transport.c
+// usage: ./ipc_bench [round_trips] [messages]
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include "ipc_transport.h"
+
+#define MAX_AUTH_STRING_LEN 100
+
+typedef struct SolverRequest {
+    long mtype;
+    int dockId;
+    char authStringGuess[MAX_AUTH_STRING_LEN];
+} SolverRequest;
+
+typedef struct SolverResponse {
+    long mtype;
+    int guessIsCorrect;
+} SolverResponse;
+
+static double now_sec() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static int cmp_double(const void *a, const void *b) {
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+// child side: echo every guess, stop on mtype 1 with dockId -1
+static void run_peer(int kind, key_t key) {
+    Transport t;
+    if (transport_open(&t, kind, key, IPC_PEER_SIDE, IPC_CREAT | 0666) == -1) {
+        perror("peer: error opening transport");
+        exit(EXIT_FAILURE);
+    }
+    SolverRequest request;
+    SolverResponse response;
+    response.mtype = 3;
+    for (;;) {
+        if (transport_recv(&t, &request, sizeof(request) - sizeof(long), -2) == -1) {
+            perror("peer: error receiving request");
+            exit(EXIT_FAILURE);
+        }
+        if (request.mtype == 1 && request.dockId == -1) {
+            break;
+        }
+        if (request.mtype == 2 && request.dockId >= 0) {
+            continue;  // one-way stream, no reply
+        }
+        response.guessIsCorrect = 0;
+        transport_send(&t, &response, sizeof(response) - sizeof(long));
+    }
+    // ack the stop so the parent knows every one-way message was drained
+    response.guessIsCorrect = 1;
+    transport_send(&t, &response, sizeof(response) - sizeof(long));
+    transport_close(&t, 0);
+    exit(EXIT_SUCCESS);
+}
+
+static void bench(int kind, const char *name, int roundTrips, int messages) {
+    key_t key = (key_t)(0x62000000 | (getpid() & 0xffff));
+    Transport t;
+    if (transport_open(&t, kind, key, IPC_SCHEDULER_SIDE, IPC_CREAT | 0666) == -1) {
+        perror("error opening transport");
+        exit(EXIT_FAILURE);
+    }
+
+    fflush(stdout);
+    pid_t pid = fork();
+    if (pid == 0) {
+        run_peer(kind, key);
+    }
+
+    SolverRequest request;
+    SolverResponse response;
+    memset(&request, 0, sizeof(request));
+    strcpy(request.authStringGuess, "5678.9");
+
+    double *lat = malloc(roundTrips * sizeof(double));
+    if (!lat) {
+        perror("Memory allocation failed");
+        exit(EXIT_FAILURE);
+    }
+
+    // round trips: guess out, verdict back
+    request.mtype = 2;
+    request.dockId = -2;
+    double start = now_sec();
+    for (int i = 0; i < roundTrips; i++) {
+        double t0 = now_sec();
+        transport_send(&t, &request, sizeof(request) - sizeof(long));
+        transport_recv(&t, &response, sizeof(response) - sizeof(long), 3);
+        lat[i] = now_sec() - t0;
+    }
+    double rtElapsed = now_sec() - start;
+    qsort(lat, roundTrips, sizeof(double), cmp_double);
+
+    // one-way stream, acked once at the end
+    request.dockId = 0;
+    start = now_sec();
+    for (int i = 0; i < messages; i++) {
+        transport_send(&t, &request, sizeof(request) - sizeof(long));
+    }
+    request.mtype = 1;
+    request.dockId = -1;
+    transport_send(&t, &request, sizeof(request) - sizeof(long));
+    transport_recv(&t, &response, sizeof(response) - sizeof(long), 3);
+    double streamElapsed = now_sec() - start;
+
+    waitpid(pid, NULL, 0);
+    transport_close(&t, 1);
+
+    printf("%-5s | rtt avg %7.2f us  p50 %7.2f us  p99 %7.2f us | %9.0f round trips/s | %10.0f msgs/s\n",
+           name, rtElapsed / roundTrips * 1e6, lat[roundTrips / 2] * 1e6,
+           lat[(int)(roundTrips * 0.99)] * 1e6, roundTrips / rtElapsed, messages / streamElapsed);
+    free(lat);
+}
+
+int main(int argc, char *argv[]) {
+    int roundTrips = argc > 1 ? atoi(argv[1]) : 100000;
+    int messages = argc > 2 ? atoi(argv[2]) : 1000000;
+    if (roundTrips <= 0 || messages <= 0) {
+        fprintf(stderr, "usage: %s [round_trips] [messages]\n", argv[0]);
+        exit(EXIT_FAILURE);
+    }
+
+    printf("%d round trips, %d one-way messages of %zu bytes\n",
+           roundTrips, messages, sizeof(SolverRequest));
+    bench(IPC_SYSV, "sysv", roundTrips, messages);
+    bench(IPC_RING, "ring", roundTrips, messages);
+    return 0;
+}
@@ -0,0 +1,231 @@
+#include "ipc_transport.h"
+
+#include <errno.h>
+#include <stdbool.h>
+#include <string.h>
+#include <sys/msg.h>
+#include <sys/shm.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+#include <unistd.h>
+
+_Static_assert((RING_SLOTS & (RING_SLOTS - 1)) == 0, "RING_SLOTS must be a power of two");
+
+// shared (not FUTEX_PRIVATE) since the other side lives in another process
+static void futex_wait(_Atomic uint32_t *addr, uint32_t val) {
+    syscall(SYS_futex, (uint32_t *)addr, FUTEX_WAIT, val, NULL, NULL, 0);
+}
+
+static void futex_wake(_Atomic uint32_t *addr) {
+    syscall(SYS_futex, (uint32_t *)addr, FUTEX_WAKE, 1, NULL, NULL, 0);
+}
+
+static inline void cpu_relax(void) {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#endif
+}
+
+static int busyPoll = -1;   // -1 until transport_set_busy_poll
+static int defaultSpin;
+
+// spinning only pays off when the other side runs on another cpu; decided
+// before main so threads only ever read it
+__attribute__((constructor))
+static void pick_spin_limit() {
+    defaultSpin = sysconf(_SC_NPROCESSORS_ONLN) > 1 ? RING_SPIN_LIMIT : 0;
+}
+
+static int spin_limit() {
+    return busyPoll >= 0 ? busyPoll : defaultSpin;
+}
+
+// spin briefly, then sleep on *word until it moves away from val
+static void ring_wait(_Atomic uint32_t *word, _Atomic uint32_t *waiting, uint32_t val) {
+    int limit = spin_limit();
+    for (int spin = 0; spin < limit; spin++) {
+        if (atomic_load_explicit(word, memory_order_acquire) != val) {
+            return;
+        }
+        cpu_relax();
+    }
+    atomic_store(waiting, 1);
+    // re-check after publishing the flag so a concurrent update can't be missed
+    while (atomic_load(word) == val) {
+        futex_wait(word, val);
+    }
+    atomic_store(waiting, 0);
+}
+
+static int ring_push(Ring *r, const void *msg, size_t msgsz) {
+    uint32_t tail = atomic_load_explicit(&r->tail, memory_order_relaxed);
+    uint32_t head = atomic_load_explicit(&r->head, memory_order_acquire);
+    while (tail - head == RING_SLOTS) {
+        ring_wait(&r->head, &r->producerWaiting, head);
+        head = atomic_load_explicit(&r->head, memory_order_acquire);
+    }
+
+    RingSlot *slot = &r->slots[tail & (RING_SLOTS - 1)];
+    slot->size = (uint32_t)msgsz;
+    memcpy(slot->data, msg, msgsz + sizeof(long));
+
+    atomic_store(&r->tail, tail + 1);
+    if (atomic_load(&r->consumerWaiting)) {
+        futex_wake(&r->tail);
+    }
+    return 0;
+}
+
+// msgrcv's type selection: any, exactly mtype, or at most -mtype
+static bool type_matches(long type, long mtype) {
+    return mtype == 0 || (mtype > 0 ? type == mtype : type <= -mtype);
+}
+
+static ssize_t ring_pop(Ring *r, void *msg, size_t msgsz, long mtype) {
+    uint32_t head = atomic_load_explicit(&r->head, memory_order_relaxed);
+    uint32_t tail = atomic_load_explicit(&r->tail, memory_order_acquire);
+    while (tail == head) {
+        ring_wait(&r->tail, &r->consumerWaiting, tail);
+        tail = atomic_load_explicit(&r->tail, memory_order_acquire);
+    }
+
+    // peek before consuming: a message of another type stays queued
+    RingSlot *slot = &r->slots[head & (RING_SLOTS - 1)];
+    long type;
+    memcpy(&type, slot->data, sizeof(long));
+    if (!type_matches(type, mtype)) {
+        errno = ENOMSG;
+        return -1;
+    }
+
+    // like msgrcv without MSG_NOERROR: too long a message stays queued
+    size_t size = slot->size;
+    if (size > msgsz) {
+        errno = E2BIG;
+        return -1;
+    }
+    memcpy(msg, slot->data, size + sizeof(long));
+
+    atomic_store(&r->head, head + 1);
+    if (atomic_load(&r->producerWaiting)) {
+        futex_wake(&r->head);
+    }
+    return (ssize_t)size;
+}
+
+static void ring_reset(Ring *r) {
+    atomic_store(&r->head, 0);
+    atomic_store(&r->tail, 0);
+    atomic_store(&r->producerWaiting, 0);
+    atomic_store(&r->consumerWaiting, 0);
+}
+
+int transport_open(Transport *t, int kind, key_t key, int side, int flags) {
+    memset(t, 0, sizeof(*t));
+    t->kind = kind;
+    t->msqid = -1;
+    t->shmid = -1;
+
+    if (kind == IPC_SYSV) {
+        t->msqid = msgget(key, flags);
+        return t->msqid == -1 ? -1 : 0;
+    }
+    if (kind != IPC_RING) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    t->shmid = shmget(key, sizeof(RingSegment), flags | IPC_CREAT);
+    if (t->shmid == -1) {
+        return -1;
+    }
+    t->seg = (RingSegment *)shmat(t->shmid, NULL, 0);
+    if (t->seg == (void *)-1) {
+        t->seg = NULL;
+        return -1;
+    }
+    // Segments outlive their users (the scheduler never removes them), so
+    // the creating side starts from empty rings unless its peer is already
+    // attached; a rerun would otherwise inherit the old head/tail.
+    struct shmid_ds ds;
+    if ((flags & IPC_CREAT) && shmctl(t->shmid, IPC_STAT, &ds) == 0 && ds.shm_nattch == 1) {
+        ring_reset(&t->seg->toPeer);
+        ring_reset(&t->seg->fromPeer);
+    }
+    if (side == IPC_SCHEDULER_SIDE) {
+        t->tx = &t->seg->toPeer;
+        t->rx = &t->seg->fromPeer;
+    } else {
+        t->tx = &t->seg->fromPeer;
+        t->rx = &t->seg->toPeer;
+    }
+    return 0;
+}
+
+int transport_send(Transport *t, const void *msg, size_t msgsz) {
+    if (t->kind == IPC_SYSV) {
+        return msgsnd(t->msqid, msg, msgsz, 0);
+    }
+    if (msgsz + sizeof(long) > RING_SLOT_BYTES) {
+        errno = EINVAL;
+        return -1;
+    }
+    return ring_push(t->tx, msg, msgsz);
+}
+
+ssize_t transport_recv(Transport *t, void *msg, size_t msgsz, long mtype) {
+    if (t->kind == IPC_SYSV) {
+        for (int spin = 0; spin < busyPoll; spin++) {
+            ssize_t got = msgrcv(t->msqid, msg, msgsz, mtype, IPC_NOWAIT);
+            if (got != -1 || errno != ENOMSG) {
+                return got;
+            }
+            cpu_relax();
+        }
+        return msgrcv(t->msqid, msg, msgsz, mtype, 0);
+    }
+    return ring_pop(t->rx, msg, msgsz, mtype);
+}
+
+ssize_t transport_try_recv(Transport *t, void *msg, size_t msgsz, long mtype) {
+    if (t->kind == IPC_SYSV) {
+        return msgrcv(t->msqid, msg, msgsz, mtype, IPC_NOWAIT);
+    }
+    Ring *r = t->rx;
+    if (atomic_load_explicit(&r->tail, memory_order_acquire) ==
+        atomic_load_explicit(&r->head, memory_order_relaxed)) {
+        errno = ENOMSG;
+        return -1;
+    }
+    return ring_pop(r, msg, msgsz, mtype);
+}
+
+void transport_set_busy_poll(int spins) {
+    busyPoll = spins < 0 || sysconf(_SC_NPROCESSORS_ONLN) == 1 ? 0 : spins;
+}
+
+void transport_close(Transport *t, int remove) {
+    if (t->kind == IPC_SYSV) {
+        if (remove && t->msqid != -1) {
+            msgctl(t->msqid, IPC_RMID, NULL);
+        }
+        return;
+    }
+    if (t->seg) {
+        shmdt(t->seg);
+        t->seg = NULL;
+    }
+    if (remove && t->shmid != -1) {
+        shmctl(t->shmid, IPC_RMID, NULL);
+    }
+}
+
+int parse_ipc_kind(const char *name) {
+    if (strcmp(name, "sysv") == 0) {
+        return IPC_SYSV;
+    }
+    if (strcmp(name, "ring") == 0) {
+        return IPC_RING;
+    }
+    return -1;
+}
@@ -0,0 +1,86 @@
+#ifndef IPC_TRANSPORT_H
+#define IPC_TRANSPORT_H
+
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <sys/types.h>
+#include <sys/ipc.h>
+
+// Transport behind every scheduler <-> validation/solver exchange.
+// IPC_SYSV is the default and maps 1:1 onto msgsnd/msgrcv.
+// IPC_RING maps a queue key onto a shared memory segment (same key) holding
+// two single-producer/single-consumer rings, one per direction, and waits on
+// futexes instead of entering the kernel for every message. Both ends of a
+// queue must use the same backend.
+
+#define IPC_SYSV 0
+#define IPC_RING 1
+
+// which end of the queue we are; ring direction depends on it
+#define IPC_SCHEDULER_SIDE 0
+#define IPC_PEER_SIDE 1
+
+#define RING_SLOTS 256           // power of two
+#define RING_SLOT_BYTES 128      // mtype + payload, fits SolverRequest
+#define RING_SPIN_LIMIT 2000     // spins before falling back to futex wait
+
+typedef struct RingSlot {
+    uint32_t size;               // payload size excluding mtype, like msgsz
+    char data[RING_SLOT_BYTES];
+} RingSlot;
+
+// head is only written by the consumer and tail only by the producer.
+// The *Waiting flags tell the other side a futex wake is needed.
+typedef struct Ring {
+    _Alignas(64) _Atomic uint32_t head;
+    _Atomic uint32_t producerWaiting;
+    _Alignas(64) _Atomic uint32_t tail;
+    _Atomic uint32_t consumerWaiting;
+    _Alignas(64) RingSlot slots[RING_SLOTS];
+} Ring;
+
+// a freshly created (zeroed) segment is two empty rings
+typedef struct RingSegment {
+    Ring toPeer;
+    Ring fromPeer;
+} RingSegment;
+
+typedef struct Transport {
+    int kind;
+    int msqid;                   // IPC_SYSV
+    int shmid;                   // IPC_RING
+    RingSegment *seg;
+    Ring *tx;
+    Ring *rx;
+} Transport;
+
+// flags are passed to msgget/shmget (IPC_CREAT is always added for rings so
+// either side may come up first). A ring opened with IPC_CREAT in flags by
+// its only attacher is reset to empty. Returns 0, or -1 with errno set.
+int transport_open(Transport *t, int kind, key_t key, int side, int flags);
+
+// Same contract as msgsnd/msgrcv: msg starts with a long mtype and msgsz
+// excludes it, and mtype selects like msgrcv's msgtyp. For rings, messages
+// are delivered in FIFO order; when the oldest one does not match mtype the
+// call returns -1/ENOMSG and leaves it queued, since every ring direction
+// only carries the types its reader asks for A message longer than msgsz
+// fails with -1/E2BIG and stays queued, as msgrcv does without MSG_NOERROR.
+int transport_send(Transport *t, const void *msg, size_t msgsz);
+ssize_t transport_recv(Transport *t, void *msg, size_t msgsz, long mtype);
+
+// transport_recv without blocking: -1/ENOMSG when nothing is queued
+ssize_t transport_try_recv(Transport *t, void *msg, size_t msgsz, long mtype);
+
+// Spin this many times on an empty queue before blocking: non-blocking
+// msgrcv attempts for sysv, and in place of the default spin limit for rings
+// (which skip spinning on single-cpu hosts). 0 turns spinning off, and so
+// does a single-cpu host, where the spinner would only hold off the peer.
+void transport_set_busy_poll(int spins);
+
+// detach; remove also deletes the underlying queue or segment
+void transport_close(Transport *t, int remove);
+
+int parse_ipc_kind(const char *name);
+
+#endif
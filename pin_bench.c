@@ -0,0 +1,279 @@
+// Auth search throughput and timestep latency with and without --pin.
+// Every timestep is one auth search shaped like guess_authString: the
+// candidate range is split over one thread per solver queue, created for
+// the search, and each guess is a SolverRequest/SolverResponse round trip
+// with a forked solver stand-in. The stand-in owning the hit answers
+// correct at a random offset and every thread stops once it is found.
+// Threads and buffers are placed the way the scheduler places them:
+// pinned threads created with the cpu in their attributes, and per-queue
+// buffers a page each, bound to the node of the queue's cpu.
+//
+// build: gcc -O2 -o pin_bench pin_bench.c ipc_transport.c cpu_topology.c -lpthread
+// usage: ./pin_bench [timesteps] [auth_length] [solvers] [--ipc=sysv|ring] [--pin=auto|<cpu_list>]
+//                    [--busy-poll=<spins>]
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include "ipc_transport.h"
+#include "cpu_topology.h"
+
+#define MAX_AUTH_STRING_LEN 100
+#define MAX_SOLVERS 8
+
+typedef struct SolverRequest {
+    long mtype;
+    int dockId;
+    char authStringGuess[MAX_AUTH_STRING_LEN];
+} SolverRequest;
+
+typedef struct SolverResponse {
+    long mtype;
+    int guessIsCorrect;
+} SolverResponse;
+
+typedef struct SolverScratch {
+    _Alignas(4096) SolverRequest request;
+    SolverResponse response;
+} SolverScratch;
+
+typedef struct Worker {
+    Transport *queue;
+    SolverScratch *scratch;
+    int start, end;
+    long guesses;
+    bool *found;
+    pthread_mutex_t *mutex;
+} Worker;
+
+static CpuTopology topology;
+static int plan[MAX_SOLVERS + 1];
+
+static double now_sec() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static int cmp_double(const void *a, const void *b) {
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+// mtype 1 starts a search: dockId is the offset of the correct guess in
+// this queue's range, -1 if the hit is elsewhere, -2 to stop
+static void run_solver(int kind, key_t key) {
+    Transport t;
+    if (transport_open(&t, kind, key, IPC_PEER_SIDE, IPC_CREAT | 0666) == -1) {
+        perror("solver: error opening transport");
+        exit(EXIT_FAILURE);
+    }
+    SolverRequest request;
+    SolverResponse response;
+    response.mtype = 3;
+    int target = -1, seen = 0;
+    for (;;) {
+        if (transport_recv(&t, &request, sizeof(request) - sizeof(long), -2) == -1) {
+            perror("solver: error receiving request");
+            exit(EXIT_FAILURE);
+        }
+        if (request.mtype == 1) {
+            if (request.dockId == -2) {
+                break;
+            }
+            target = request.dockId;
+            seen = 0;
+            continue;
+        }
+        response.guessIsCorrect = seen++ == target;
+        transport_send(&t, &response, sizeof(response) - sizeof(long));
+    }
+    transport_close(&t, 0);
+    exit(EXIT_SUCCESS);
+}
+
+static void *search(void *arg) {
+    Worker *w = (Worker *)arg;
+    SolverRequest *request = &w->scratch->request;
+    SolverResponse *response = &w->scratch->response;
+    request->mtype = 2;
+    memset(request->authStringGuess, '5', 8);
+    request->authStringGuess[8] = '\0';
+    for (int i = w->start; i < w->end; i++) {
+        pthread_mutex_lock(w->mutex);
+        bool found = *w->found;
+        pthread_mutex_unlock(w->mutex);
+        if (found) {
+            break;
+        }
+        request->authStringGuess[i % 8] = "56789."[i % 6];
+        transport_send(w->queue, request, sizeof(*request) - sizeof(long));
+        transport_recv(w->queue, response, sizeof(*response) - sizeof(long), 3);
+        w->guesses++;
+        if (response->guessIsCorrect == 1) {
+            pthread_mutex_lock(w->mutex);
+            *w->found = true;
+            pthread_mutex_unlock(w->mutex);
+            break;
+        }
+    }
+    return NULL;
+}
+
+static void bench(int kind, bool pinned, int timesteps, long long space, int solvers) {
+    Transport queues[MAX_SOLVERS];
+    pid_t pids[MAX_SOLVERS];
+    pthread_attr_t attrs[MAX_SOLVERS];
+    SolverScratch *scratch = mmap(NULL, solvers * sizeof(SolverScratch), PROT_READ | PROT_WRITE,
+                                  MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (scratch == MAP_FAILED) {
+        perror("error allocating buffers");
+        exit(EXIT_FAILURE);
+    }
+
+    cpu_set_t all;
+    CPU_ZERO(&all);
+    for (int i = 0; i < topology.numCpus; i++) {
+        CPU_SET(topology.cpus[i].cpu, &all);
+    }
+    if (pinned) {
+        pin_thread(pthread_self(), plan[0]);
+    } else {
+        pthread_setaffinity_np(pthread_self(), sizeof(all), &all);
+    }
+
+    fflush(stdout);
+    for (int i = 0; i < solvers; i++) {
+        key_t key = (key_t)(0x63000000 | ((getpid() & 0xfff) << 4) | i);
+        if (transport_open(&queues[i], kind, key, IPC_SCHEDULER_SIDE, IPC_CREAT | 0666) == -1) {
+            perror("error opening transport");
+            exit(EXIT_FAILURE);
+        }
+        if ((pids[i] = fork()) == 0) {
+            // solvers are someone else's processes; they float either way
+            pthread_setaffinity_np(pthread_self(), sizeof(all), &all);
+            run_solver(kind, key);
+        }
+        pthread_attr_init(&attrs[i]);
+        if (pinned) {
+            pin_attr(&attrs[i], plan[1 + i]);
+            bind_to_node(&topology, &scratch[i], sizeof(SolverScratch), topology_node_of(&topology, plan[1 + i]));
+        }
+    }
+
+    double *lat = malloc(timesteps * sizeof(double));
+    if (!lat) {
+        perror("Memory allocation failed");
+        exit(EXIT_FAILURE);
+    }
+    srand(12345);
+    long guesses = 0;
+    double start = now_sec();
+    for (int t = 0; t < timesteps; t++) {
+        double t0 = now_sec();
+        long long hit = ((long long)rand() * RAND_MAX + rand()) % space;
+        int share = (int)(space / solvers);
+        pthread_t threads[MAX_SOLVERS];
+        Worker workers[MAX_SOLVERS];
+        pthread_mutex_t mutex = PTHREAD_MUTEX_INITIALIZER;
+        bool found = false;
+
+        for (int i = 0; i < solvers; i++) {
+            workers[i] = (Worker){ &queues[i], &scratch[i], i * share,
+                                   i == solvers - 1 ? (int)space : (i + 1) * share, 0, &found, &mutex };
+            SolverRequest *request = &scratch[i].request;
+            request->mtype = 1;
+            request->dockId = hit >= workers[i].start && hit < workers[i].end ? (int)(hit - workers[i].start) : -1;
+            transport_send(&queues[i], request, sizeof(*request) - sizeof(long));
+            pthread_create(&threads[i], &attrs[i], search, &workers[i]);
+        }
+        for (int i = 0; i < solvers; i++) {
+            pthread_join(threads[i], NULL);
+            guesses += workers[i].guesses;
+        }
+        lat[t] = now_sec() - t0;
+    }
+    double elapsed = now_sec() - start;
+    qsort(lat, timesteps, sizeof(double), cmp_double);
+
+    for (int i = 0; i < solvers; i++) {
+        SolverRequest stop = { 1, -2, "" };
+        transport_send(&queues[i], &stop, sizeof(stop) - sizeof(long));
+        waitpid(pids[i], NULL, 0);
+        transport_close(&queues[i], 1);
+        pthread_attr_destroy(&attrs[i]);
+    }
+    munmap(scratch, solvers * sizeof(SolverScratch));
+
+    printf("%-4s %-8s | %10.0f guesses/s | timestep avg %8.2f ms  p50 %8.2f ms  p99 %8.2f ms\n",
+           kind == IPC_SYSV ? "sysv" : "ring", pinned ? "pinned" : "floating", guesses / elapsed,
+           elapsed / timesteps * 1e3, lat[timesteps / 2] * 1e3, lat[(int)(timesteps * 0.99)] * 1e3);
+    free(lat);
+}
+
+int main(int argc, char *argv[]) {
+    int positional[3] = { 200, 6, 2 };
+    int npos = 0, kind = IPC_SYSV;
+    const char *pinSpec = "auto";
+    for (int i = 1; i < argc; i++) {
+        if (strncmp(argv[i], "--ipc=", 6) == 0) {
+            kind = parse_ipc_kind(argv[i] + 6);
+        } else if (strncmp(argv[i], "--pin=", 6) == 0) {
+            pinSpec = argv[i] + 6;
+        } else if (strncmp(argv[i], "--busy-poll=", 12) == 0) {
+            transport_set_busy_poll(atoi(argv[i] + 12));
+        } else if (npos < 3 && argv[i][0] != '-') {
+            positional[npos++] = atoi(argv[i]);
+        } else {
+            kind = -1;
+        }
+    }
+    int timesteps = positional[0], length = positional[1], solvers = positional[2];
+    if (kind == -1 || timesteps <= 0 || length < 1 || length > 9 || solvers < 1 || solvers > MAX_SOLVERS) {
+        fprintf(stderr, "usage: %s [timesteps] [auth_length 1-9] [solvers 1-%d] [--ipc=sysv|ring]"
+                " [--pin=auto|<cpu_list>] [--busy-poll=<spins>]\n", argv[0], MAX_SOLVERS);
+        exit(EXIT_FAILURE);
+    }
+
+    if (topology_load(&topology) == -1) {
+        fprintf(stderr, "could not read cpu topology\n");
+        exit(EXIT_FAILURE);
+    }
+    if (strcmp(pinSpec, "auto") == 0) {
+        topology_plan(&topology, plan, solvers + 1);
+    } else {
+        int list[MAX_SOLVERS + 1];
+        int len = parse_cpu_list(pinSpec, list, MAX_SOLVERS + 1);
+        if (len <= 0) {
+            fprintf(stderr, "bad cpu list %s\n", pinSpec);
+            exit(EXIT_FAILURE);
+        }
+        for (int i = 0; i <= solvers; i++) {
+            plan[i] = list[i % len];
+        }
+    }
+
+    // same count as auth_space_size
+    long long space = 5;
+    for (int i = 1; i < length - 1; i++) {
+        space *= 6;
+    }
+    if (length > 1) {
+        space *= 5;
+    }
+    printf("%d timesteps, auth length %d (%lld candidates), %d solver queues, %d cpus on %d nodes, plan:",
+           timesteps, length, space, solvers, topology.numCpus, topology.numNodes);
+    for (int i = 0; i <= solvers; i++) {
+        printf(" %d", plan[i]);
+    }
+    printf("\n");
+    bench(kind, false, timesteps, space, solvers);
+    bench(kind, true, timesteps, space, solvers);
+    return 0;
+}
@@ -0,0 +1,195 @@
+// Many ports in one scheduler process against one scheduler process per
+// port. Each run forks a port_standin per testcase (validation and solvers
+// for that port), then either one `scheduler <tc>...` for all of them or
+// one `scheduler <tc>` each, and waits for everything to finish. Reports
+// wall time from starting the schedulers to the last stand-in exiting,
+// scheduler CPU time and the schedulers' peak RSS added up over processes,
+// as reported by wait4.
+//
+// build: gcc -O2 -o port_bench port_bench.c
+// usage: ./port_bench [ports] [timesteps] [solvers] [--ipc=sysv|ring] [--first=<testcase>]
+//                     [--scheduler=<path>] [--standin=<path>] [-- <scheduler args>...]
+//        from a scratch directory; the stand-ins write testcase<N>/ there.
+// Exits non-zero if a stand-in saw a broken rule or a scheduler failed.
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+
+#define MAX_PORTS 256
+#define MAX_ARGS (MAX_PORTS + 64)
+#define STANDIN_SETUP_US 300000
+
+typedef struct Config {
+    int ports, timesteps, solvers, first;
+    const char *ipc;
+    const char *scheduler, *standin;
+    char **extra;
+    int numExtra;
+} Config;
+
+typedef struct Result {
+    double wallSec;
+    double cpuSec;
+    long rssKb;
+    int processes;
+    bool failed;
+} Result;
+
+static double now_sec() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static pid_t spawn(char **argv, const char *log) {
+    fflush(stdout);
+    pid_t pid = fork();
+    if (pid == -1) {
+        perror("fork");
+        exit(EXIT_FAILURE);
+    }
+    if (pid == 0) {
+        if (!freopen(log, "w", stdout) || !freopen(log, "a", stderr)) {
+            _exit(127);
+        }
+        execv(argv[0], argv);
+        perror(argv[0]);
+        _exit(127);
+    }
+    return pid;
+}
+
+static pid_t start_standin(const Config *cfg, int tc) {
+    char tcArg[16], steps[16], solvers[16], log[64];
+    snprintf(tcArg, sizeof(tcArg), "%d", tc);
+    snprintf(steps, sizeof(steps), "%d", cfg->timesteps);
+    snprintf(solvers, sizeof(solvers), "%d", cfg->solvers);
+    snprintf(log, sizeof(log), "standin_%d.log", tc);
+    // the testcase doubles as the seed, so both layouts see the same ports
+    char *argv[] = { (char *)cfg->standin, tcArg, steps, solvers, tcArg, (char *)cfg->ipc, NULL };
+    return spawn(argv, log);
+}
+
+// testcases [from, to) in one scheduler process
+static pid_t start_scheduler(const Config *cfg, int from, int to) {
+    static char numbers[MAX_PORTS][16];
+    char *argv[MAX_ARGS];
+    char log[64];
+    int argc = 0;
+    argv[argc++] = (char *)cfg->scheduler;
+    for (int tc = from; tc < to; tc++) {
+        snprintf(numbers[tc - cfg->first], sizeof(numbers[0]), "%d", tc);
+        argv[argc++] = numbers[tc - cfg->first];
+    }
+    argv[argc++] = (char *)cfg->ipc;
+    for (int i = 0; i < cfg->numExtra; i++) {
+        argv[argc++] = cfg->extra[i];
+    }
+    argv[argc] = NULL;
+    snprintf(log, sizeof(log), "scheduler_%d.log", from);
+    return spawn(argv, log);
+}
+
+static Result run(const Config *cfg, bool onePerPort) {
+    Result r = { 0 };
+    pid_t standins[MAX_PORTS], schedulers[MAX_PORTS];
+    for (int i = 0; i < cfg->ports; i++) {
+        standins[i] = start_standin(cfg, cfg->first + i);
+    }
+    usleep(STANDIN_SETUP_US);
+
+    double start = now_sec();
+    int numSchedulers = 0;
+    if (onePerPort) {
+        for (int i = 0; i < cfg->ports; i++) {
+            schedulers[numSchedulers++] = start_scheduler(cfg, cfg->first + i, cfg->first + i + 1);
+        }
+    } else {
+        schedulers[numSchedulers++] = start_scheduler(cfg, cfg->first, cfg->first + cfg->ports);
+    }
+    for (int i = 0; i < numSchedulers; i++) {
+        int status;
+        struct rusage usage;
+        if (wait4(schedulers[i], &status, 0, &usage) == -1) {
+            perror("wait4");
+            exit(EXIT_FAILURE);
+        }
+        if (WIFSIGNALED(status)) {
+            fprintf(stderr, "scheduler %d killed by signal %d\n", i, WTERMSIG(status));
+            r.failed = true;
+        } else if (WEXITSTATUS(status) != 0) {
+            fprintf(stderr, "scheduler %d exited with %d\n", i, WEXITSTATUS(status));
+            r.failed = true;
+        }
+        r.cpuSec += usage.ru_utime.tv_sec + usage.ru_utime.tv_usec / 1e6
+                  + usage.ru_stime.tv_sec + usage.ru_stime.tv_usec / 1e6;
+        r.rssKb += usage.ru_maxrss;
+    }
+    for (int i = 0; i < cfg->ports; i++) {
+        int status;
+        waitpid(standins[i], &status, 0);
+        if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+            fprintf(stderr, "testcase %d: stand-in reported errors, see standin_%d.log\n",
+                    cfg->first + i, cfg->first + i);
+            r.failed = true;
+        }
+    }
+    r.wallSec = now_sec() - start;
+    r.processes = numSchedulers;
+    return r;
+}
+
+static void report(const char *layout, const Result *r) {
+    printf("%-18s %3d processes | wall %7.2f s | scheduler cpu %7.2f s | peak rss %8ld KB%s\n",
+           layout, r->processes, r->wallSec, r->cpuSec, r->rssKb, r->failed ? " | FAILED" : "");
+}
+
+int main(int argc, char *argv[]) {
+    Config cfg = { .ports = 50, .timesteps = 200, .solvers = 2, .first = 201, .ipc = "--ipc=sysv",
+                   .scheduler = "./scheduler", .standin = "./port_standin" };
+    int positional[3] = { cfg.ports, cfg.timesteps, cfg.solvers };
+    int npos = 0;
+    bool bad = false;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--") == 0) {
+            cfg.extra = argv + i + 1;
+            cfg.numExtra = argc - i - 1;
+            break;
+        } else if (strncmp(argv[i], "--ipc=", 6) == 0) {
+            cfg.ipc = argv[i];
+        } else if (strncmp(argv[i], "--first=", 8) == 0) {
+            cfg.first = atoi(argv[i] + 8);
+        } else if (strncmp(argv[i], "--scheduler=", 12) == 0) {
+            cfg.scheduler = argv[i] + 12;
+        } else if (strncmp(argv[i], "--standin=", 10) == 0) {
+            cfg.standin = argv[i] + 10;
+        } else if (npos < 3 && argv[i][0] != '-') {
+            positional[npos++] = atoi(argv[i]);
+        } else {
+            bad = true;
+        }
+    }
+    cfg.ports = positional[0];
+    cfg.timesteps = positional[1];
+    cfg.solvers = positional[2];
+    if (bad || cfg.ports < 1 || cfg.ports > MAX_PORTS || cfg.timesteps < 1 || cfg.solvers < 1
+        || cfg.first < 1 || cfg.numExtra > MAX_ARGS - MAX_PORTS - 3) {
+        fprintf(stderr, "usage: %s [ports 1-%d] [timesteps] [solvers] [--ipc=sysv|ring] [--first=<testcase>]"
+                " [--scheduler=<path>] [--standin=<path>] [-- <scheduler args>...]\n", argv[0], MAX_PORTS);
+        exit(EXIT_FAILURE);
+    }
+
+    printf("%d ports (testcases %d-%d), %d timesteps, %d solver queues each, %s\n", cfg.ports, cfg.first,
+           cfg.first + cfg.ports - 1, cfg.timesteps, cfg.solvers, cfg.ipc + 6);
+    Result multi = run(&cfg, false);
+    report("one process", &multi);
+    Result separate = run(&cfg, true);
+    report("process per port", &separate);
+    return multi.failed || separate.failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
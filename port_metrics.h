@@ -0,0 +1,83 @@
+#ifndef PORT_METRICS_H
+#define PORT_METRICS_H
+
+#include <stdatomic.h>
+#include <stdint.h>
+#include <string.h>
+
+// Read-only telemetry page the scheduler republishes once per timestep
+// (--metrics=<shm_key>) and port_top displays. There is a single writer, so
+// a seqlock is enough: seq is odd while an update is in flight and readers
+// retry until they copy a snapshot with the same even seq on both sides.
+// Counters marked cumulative only ever grow; rates are taken by readers
+// from two snapshots and publishedNs.
+
+#define METRICS_MAX_DOCKS 30       // MAX_DOCKS
+#define METRICS_MAX_SOLVERS 8      // MAX_SOLVERS
+#define METRICS_MAX_CATEGORY 25    // MAX_CATEGORY
+#define METRICS_AUTH_LEN_BUCKETS 32   // last bucket counts everything longer
+
+typedef struct DockMetrics {
+    int32_t occupied;
+    int32_t shipId;
+    int32_t direction;
+    int32_t category;
+    int32_t numCranes;
+    int32_t cranesUsed;           // cranes moving cargo this timestep
+    int64_t busySteps;            // cumulative timesteps occupied
+    int64_t craneMoves;           // cumulative cargo moves
+} DockMetrics;
+
+typedef struct PortMetrics {
+    _Atomic uint32_t seq;
+    int32_t finished;
+    int32_t timestep;
+    int32_t numDocks;
+    int32_t numSolvers;
+    int64_t publishedNs;          // CLOCK_MONOTONIC at publish
+    int64_t timesteps;            // cumulative timesteps handled
+
+    int32_t totalShips;
+    int32_t servicedShips;
+    int32_t waitingEmergency;
+    // [category][0] incoming, [category][1] outgoing, regular ships only
+    int32_t waiting[METRICS_MAX_CATEGORY + 1][2];
+
+    DockMetrics docks[METRICS_MAX_DOCKS];
+
+    int64_t solverGuesses[METRICS_MAX_SOLVERS];    // cumulative
+    int64_t authSearches;                          // cumulative
+    int64_t authLenCount[METRICS_AUTH_LEN_BUCKETS];   // cumulative, by length
+
+    // cumulative message counts; one syscall each on the sysv backend
+    int64_t mainSent;
+    int64_t mainRecv;
+    int64_t solverSent[METRICS_MAX_SOLVERS];
+    int64_t solverRecv[METRICS_MAX_SOLVERS];
+} PortMetrics;
+
+static inline void metrics_write_begin(PortMetrics *pm) {
+    atomic_fetch_add_explicit(&pm->seq, 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+}
+
+static inline void metrics_write_end(PortMetrics *pm) {
+    atomic_fetch_add_explicit(&pm->seq, 1, memory_order_release);
+}
+
+// copy a consistent snapshot out of the shared page
+static inline void metrics_read(const PortMetrics *pm, PortMetrics *out) {
+    for (;;) {
+        uint32_t before = atomic_load_explicit((_Atomic uint32_t *)&pm->seq, memory_order_acquire);
+        if (before & 1) {
+            continue;
+        }
+        memcpy(out, (const void *)pm, sizeof(PortMetrics));
+        atomic_thread_fence(memory_order_acquire);
+        if (atomic_load_explicit((_Atomic uint32_t *)&pm->seq, memory_order_relaxed) == before) {
+            return;
+        }
+    }
+}
+
+#endif
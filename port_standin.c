@@ -0,0 +1,442 @@
+// Validation and solver stand-in for one port, over either IPC backend, so
+// the scheduler can be run and checked without the course's validation
+// binary. It writes testcase<N>/input.txt, creates the shared memory and
+// queues, forks one solver per solver queue and then plays validation for
+// the given number of timesteps: new ships every timestep, regular ships
+// whose waiting time ran out sent again a third of the time, and every
+// message the scheduler sends checked against the port's rules (dock fits,
+// waiting time, crane capacity, one item per crane per timestep, auth
+// string on undock). The auth string of a dock depends only on the dock
+// and its length, so runs with the same seed are reproducible.
+//
+// build: gcc -O2 -o port_standin port_standin.c ipc_transport.c
+// usage: ./port_standin <testcase> [timesteps] [solvers] [seed] [--ipc=sysv|ring] [--trace]
+//        then ./scheduler <testcase> [--ipc=...] from the same directory.
+// Exits non-zero if the scheduler broke a rule.
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/msg.h>
+#include <sys/shm.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <signal.h>
+#include "ipc_transport.h"
+
+#define MAX_AUTH_STRING_LEN 100
+#define MAX_NEW_REQUESTS 100
+#define MAX_CARGO_COUNT 200
+#define MAX_DOCKS 30
+#define MAX_SOLVERS 8
+#define MAX_SHIPS 4096
+#define MAX_TESTCASE 0xffff
+#define DRAIN_TIMEOUT_MS 60000
+
+typedef struct ShipRequest {
+    int shipId;
+    int timestep;
+    int category;
+    int direction;
+    int emergency;
+    int waitingTime;
+    int numCargo;
+    int cargo[MAX_CARGO_COUNT];
+} ShipRequest;
+
+typedef struct MainSharedMemory {
+    char authStrings[MAX_DOCKS][MAX_AUTH_STRING_LEN];
+    ShipRequest newShipRequests[MAX_NEW_REQUESTS];
+} MainSharedMemory;
+
+typedef struct MessageStruct {
+    long mtype;
+    int timestep;
+    int shipId;
+    int direction;
+    int dockId;
+    int cargoId;
+    int isFinished;
+    union {
+        int numShipRequests;
+        int craneId;
+    };
+} MessageStruct;
+
+typedef struct SolverRequest {
+    long mtype;
+    int dockId;
+    char authStringGuess[MAX_AUTH_STRING_LEN];
+} SolverRequest;
+
+typedef struct SolverResponse {
+    long mtype;
+    int guessIsCorrect;
+} SolverResponse;
+
+typedef struct StandinDock {
+    int category;
+    int capacity[MAX_DOCKS];
+    int shipIndex;              // -1 when free
+    int dockedAt;
+    int lastCargoAt;
+    unsigned cranesUsed;        // this timestep
+} StandinDock;
+
+typedef struct StandinShip {
+    ShipRequest req;            // timestep is the latest arrival
+    int status;                 // 0 waiting, 1 docked, 2 undocked
+    int dock;
+    int moved;
+    bool cargoMoved[MAX_CARGO_COUNT];
+} StandinShip;
+
+static int kind = IPC_SYSV;
+static bool trace = false;
+static StandinDock docks[MAX_DOCKS];
+static int numDocks;
+static int liftLimit[MAX_DOCKS + 1];    // heaviest item every dock of at least that category can lift
+static StandinShip ships[MAX_SHIPS];
+static int numShips;
+static long errors;
+
+// one key range per testcase: shared memory, main queue, then the solver queues
+static key_t port_key(int tc, int role) {
+    return (key_t)(0x5d000000 | tc << 8 | role);
+}
+
+// the auth string validation expects for a dock at a given length
+static void expected_auth(int dockId, int length, char *out) {
+    const char *mid = "56789.", *end = "56789";
+    unsigned h = 2166136261u ^ (unsigned)dockId * 131u ^ (unsigned)length * 7919u;
+    for (int i = 0; i < length; i++) {
+        h = (h ^ (unsigned)i) * 16777619u;
+        h ^= h >> 13;
+        out[i] = i == 0 || i == length - 1 ? end[h % 5] : mid[h % 6];
+    }
+    out[length] = '\0';
+}
+
+static void violation(int t, const char *what, const MessageStruct *msg) {
+    fprintf(stderr, "t=%d: %s (type %ld ship %d dir %d dock %d cargo %d crane %d)\n", t, what, msg->mtype,
+            msg->shipId, msg->direction, msg->dockId, msg->cargoId, msg->craneId);
+    errors++;
+}
+
+// mtype 1 names the dock of the next search, mtype 2 is a guess; runs
+// until killed
+static _Noreturn void run_solver(Transport *t) {
+    SolverRequest request;
+    SolverResponse response = { 3, 0 };
+    char answer[MAX_AUTH_STRING_LEN];
+    int dockId = -1;
+    for (;;) {
+        if (transport_recv(t, &request, sizeof(request) - sizeof(long), -2) == -1) {
+            perror("solver: error receiving request");
+            exit(EXIT_FAILURE);
+        }
+        if (request.mtype == 1) {
+            dockId = request.dockId;
+            continue;
+        }
+        int length = (int)strnlen(request.authStringGuess, MAX_AUTH_STRING_LEN - 1);
+        expected_auth(dockId, length, answer);
+        response.guessIsCorrect = strcmp(answer, request.authStringGuess) == 0;
+        if (transport_send(t, &response, sizeof(response) - sizeof(long)) == -1) {
+            perror("solver: error sending response");
+            exit(EXIT_FAILURE);
+        }
+    }
+}
+
+// a fresh queue or segment, whatever a previous run left behind
+static void open_fresh(Transport *t, key_t key) {
+    if (transport_open(t, kind, key, IPC_PEER_SIDE, IPC_CREAT | 0666) == -1) {
+        perror("error opening transport");
+        exit(EXIT_FAILURE);
+    }
+    transport_close(t, 1);
+    if (transport_open(t, kind, key, IPC_PEER_SIDE, IPC_CREAT | 0666) == -1) {
+        perror("error opening transport");
+        exit(EXIT_FAILURE);
+    }
+}
+
+// On sysv both directions share the queue, so skip the timestep messages
+// the scheduler has not picked up yet.
+static void recv_from_scheduler(Transport *t, MessageStruct *msg) {
+    ssize_t got = kind == IPC_SYSV
+                  ? msgrcv(t->msqid, msg, sizeof(*msg) - sizeof(long), 1, MSG_EXCEPT)
+                  : transport_recv(t, msg, sizeof(*msg) - sizeof(long), 0);
+    if (got == -1) {
+        perror("error receiving from scheduler");
+        exit(EXIT_FAILURE);
+    }
+}
+
+// until the scheduler has taken everything sent to it, so removing the
+// queue can't drop the final message
+static void wait_drained(Transport *t) {
+    for (int ms = 0; ms < DRAIN_TIMEOUT_MS; ms++) {
+        if (kind == IPC_SYSV) {
+            struct msqid_ds ds;
+            if (msgctl(t->msqid, IPC_STAT, &ds) == -1 || ds.msg_qnum == 0) {
+                return;
+            }
+        } else if (atomic_load(&t->tx->head) == atomic_load(&t->tx->tail)) {
+            return;
+        }
+        usleep(1000);
+    }
+}
+
+static void write_input(int tc, int solvers, unsigned *rng) {
+    char path[64];
+    snprintf(path, sizeof(path), "testcase%d", tc);
+    if (mkdir(path, 0777) == -1 && errno != EEXIST) {
+        perror("error creating testcase directory");
+        exit(EXIT_FAILURE);
+    }
+    snprintf(path, sizeof(path), "testcase%d/input.txt", tc);
+    FILE *fp = fopen(path, "w");
+    if (fp == NULL) {
+        perror("error writing input file");
+        exit(EXIT_FAILURE);
+    }
+    fprintf(fp, "%d\n%d\n%d\n", port_key(tc, 0), port_key(tc, 1), solvers);
+    for (int i = 0; i < solvers; i++) {
+        fprintf(fp, "%d\n", port_key(tc, 2 + i));
+    }
+    numDocks = 4 + rand_r(rng) % 5;
+    fprintf(fp, "%d\n", numDocks);
+    for (int d = 0; d < numDocks; d++) {
+        docks[d].category = 1 + rand_r(rng) % 6;
+        docks[d].shipIndex = -1;
+        fprintf(fp, "%d", docks[d].category);
+        for (int c = 0; c < docks[d].category; c++) {
+            docks[d].capacity[c] = 5 + rand_r(rng) % 40;
+            fprintf(fp, " %d", docks[d].capacity[c]);
+        }
+        fprintf(fp, "\n");
+    }
+    fclose(fp);
+
+    // a ship may be given any dock of its category or above, so every item
+    // has to fit some crane at each of them
+    for (int c = 1; c <= MAX_DOCKS; c++) {
+        liftLimit[c] = 0;
+        for (int d = 0; d < numDocks; d++) {
+            int strongest = 0;
+            for (int j = 0; j < docks[d].category; j++) {
+                strongest = docks[d].capacity[j] > strongest ? docks[d].capacity[j] : strongest;
+            }
+            if (docks[d].category >= c && (liftLimit[c] == 0 || strongest < liftLimit[c])) {
+                liftLimit[c] = strongest;
+            }
+        }
+    }
+}
+
+static int max_category() {
+    int best = 0;
+    for (int d = 0; d < numDocks; d++) {
+        best = docks[d].category > best ? docks[d].category : best;
+    }
+    return best;
+}
+
+// this timestep's requests into shared memory; returns how many
+static int fill_requests(MainSharedMemory *sm, int t, unsigned *rng) {
+    int k = 0;
+    int arrivals = rand_r(rng) % 4;
+    for (int i = 0; i < arrivals && numShips < MAX_SHIPS; i++) {
+        StandinShip *ship = &ships[numShips];
+        ShipRequest *req = &ship->req;
+        memset(ship, 0, sizeof(*ship));
+        req->shipId = numShips++;
+        req->timestep = t;
+        req->category = 1 + rand_r(rng) % max_category();
+        req->direction = rand_r(rng) % 3 ? 1 : -1;
+        req->emergency = req->direction == 1 && rand_r(rng) % 6 == 0;
+        req->waitingTime = 2 + rand_r(rng) % 6;
+        req->numCargo = 1 + rand_r(rng) % 8;
+        for (int c = 0; c < req->numCargo; c++) {
+            req->cargo[c] = 1 + rand_r(rng) % liftLimit[req->category];
+        }
+        ship->dock = -1;
+        sm->newShipRequests[k++] = *req;
+    }
+    for (int i = 0; i < numShips && k < MAX_NEW_REQUESTS; i++) {
+        ShipRequest *req = &ships[i].req;
+        if (ships[i].status == 0 && req->direction == 1 && !req->emergency
+            && req->timestep + req->waitingTime < t && rand_r(rng) % 3 == 0) {
+            req->timestep = t;
+            sm->newShipRequests[k++] = *req;
+        }
+    }
+    return k;
+}
+
+static StandinShip *ship_of(const MessageStruct *msg) {
+    if (msg->shipId < 0 || msg->shipId >= numShips || ships[msg->shipId].req.direction != msg->direction) {
+        return NULL;
+    }
+    return &ships[msg->shipId];
+}
+
+static void check_message(MainSharedMemory *sm, int t, const MessageStruct *msg) {
+    StandinShip *ship = ship_of(msg);
+    if (!ship || msg->dockId < 0 || msg->dockId >= numDocks) {
+        violation(t, "unknown ship or dock", msg);
+        return;
+    }
+    StandinDock *dock = &docks[msg->dockId];
+    const ShipRequest *req = &ship->req;
+    switch (msg->mtype) {
+    case 2:
+        if (ship->status != 0 || dock->shipIndex != -1) {
+            violation(t, "docked a ship that is not waiting, or at a busy dock", msg);
+        } else if (dock->category < req->category) {
+            violation(t, "dock too small for the ship", msg);
+        } else if (req->direction == 1 && !req->emergency && t > req->timestep + req->waitingTime) {
+            violation(t, "docked after the waiting time ran out", msg);
+        } else {
+            ship->status = 1;
+            ship->dock = msg->dockId;
+            dock->shipIndex = msg->shipId;
+            dock->dockedAt = t;
+        }
+        break;
+    case 4:
+        if (ship->status != 1 || ship->dock != msg->dockId || t == dock->dockedAt) {
+            violation(t, "cargo moved for a ship not docked there, or in its docking timestep", msg);
+        } else if (msg->cargoId < 0 || msg->cargoId >= req->numCargo || ship->cargoMoved[msg->cargoId]) {
+            violation(t, "bad or repeated cargo item", msg);
+        } else if (msg->craneId < 0 || msg->craneId >= dock->category || dock->cranesUsed & 1u << msg->craneId) {
+            violation(t, "bad crane, or a crane used twice in one timestep", msg);
+        } else if (dock->capacity[msg->craneId] < req->cargo[msg->cargoId]) {
+            violation(t, "cargo heavier than the crane", msg);
+        } else {
+            dock->cranesUsed |= 1u << msg->craneId;
+            ship->cargoMoved[msg->cargoId] = true;
+            ship->moved++;
+            dock->lastCargoAt = t;
+        }
+        break;
+    case 3: {
+        char answer[MAX_AUTH_STRING_LEN];
+        int length = dock->lastCargoAt - dock->dockedAt;
+        if (ship->status != 1 || ship->dock != msg->dockId || ship->moved != req->numCargo
+            || dock->lastCargoAt >= t || length <= 0 || length >= MAX_AUTH_STRING_LEN) {
+            violation(t, "undocked before all cargo was moved", msg);
+            break;
+        }
+        expected_auth(msg->dockId, length, answer);
+        if (strncmp(sm->authStrings[msg->dockId], answer, MAX_AUTH_STRING_LEN) != 0) {
+            violation(t, "wrong auth string", msg);
+        }
+        ship->status = 2;
+        dock->shipIndex = -1;
+        break;
+    }
+    default:
+        violation(t, "unexpected message type", msg);
+    }
+}
+
+int main(int argc, char *argv[]) {
+    int positional[4] = { 0, 200, 2, 1 };
+    int npos = 0;
+    for (int i = 1; i < argc; i++) {
+        if (strncmp(argv[i], "--ipc=", 6) == 0) {
+            kind = parse_ipc_kind(argv[i] + 6);
+        } else if (strcmp(argv[i], "--trace") == 0) {
+            trace = true;
+        } else if (npos < 4 && argv[i][0] != '-') {
+            positional[npos++] = atoi(argv[i]);
+        } else {
+            kind = -1;
+        }
+    }
+    int tc = positional[0], steps = positional[1], solvers = positional[2];
+    unsigned rng = (unsigned)positional[3];
+    if (kind == -1 || tc <= 0 || tc > MAX_TESTCASE || steps <= 0 || solvers < 1 || solvers > MAX_SOLVERS) {
+        fprintf(stderr, "usage: %s <testcase> [timesteps] [solvers 1-%d] [seed] [--ipc=sysv|ring] [--trace]\n",
+                argv[0], MAX_SOLVERS);
+        exit(EXIT_FAILURE);
+    }
+    write_input(tc, solvers, &rng);
+
+    int shmid = shmget(port_key(tc, 0), sizeof(MainSharedMemory), IPC_CREAT | 0666);
+    MainSharedMemory *sm = shmid == -1 ? (void *)-1 : shmat(shmid, NULL, 0);
+    if (sm == (void *)-1) {
+        perror("error creating shared memory");
+        exit(EXIT_FAILURE);
+    }
+    memset(sm, 0, sizeof(*sm));
+    Transport mainQueue, solverQueues[MAX_SOLVERS];
+    pid_t solverPids[MAX_SOLVERS];
+    open_fresh(&mainQueue, port_key(tc, 1));
+    fflush(stdout);
+    for (int i = 0; i < solvers; i++) {
+        open_fresh(&solverQueues[i], port_key(tc, 2 + i));
+        if ((solverPids[i] = fork()) == 0) {
+            run_solver(&solverQueues[i]);
+        }
+    }
+
+    long msgs = 0;
+    for (int t = 1; t <= steps + 1; t++) {
+        MessageStruct msg;
+        memset(&msg, 0, sizeof(msg));
+        msg.mtype = 1;
+        msg.timestep = t;
+        msg.isFinished = t == steps + 1;
+        msg.numShipRequests = msg.isFinished ? 0 : fill_requests(sm, t, &rng);
+        if (transport_send(&mainQueue, &msg, sizeof(msg) - sizeof(long)) == -1) {
+            perror("error sending timestep");
+            exit(EXIT_FAILURE);
+        }
+        if (msg.isFinished) {
+            break;
+        }
+        for (int d = 0; d < numDocks; d++) {
+            docks[d].cranesUsed = 0;
+        }
+        for (;;) {
+            recv_from_scheduler(&mainQueue, &msg);
+            if (msg.mtype == 5) {
+                break;
+            }
+            msgs++;
+            if (trace) {
+                printf("t=%d type=%ld ship=%d dir=%d dock=%d cargo=%d crane=%d\n", t, msg.mtype, msg.shipId,
+                       msg.direction, msg.dockId, msg.cargoId, msg.craneId);
+            }
+            check_message(sm, t, &msg);
+        }
+    }
+    wait_drained(&mainQueue);
+
+    int served = 0, docked = 0;
+    for (int i = 0; i < numShips; i++) {
+        served += ships[i].status == 2;
+        docked += ships[i].status == 1;
+    }
+    for (int i = 0; i < solvers; i++) {
+        kill(solverPids[i], SIGTERM);
+        waitpid(solverPids[i], NULL, 0);
+        transport_close(&solverQueues[i], 1);
+    }
+    transport_close(&mainQueue, 1);
+    shmdt(sm);
+    shmctl(shmid, IPC_RMID, NULL);
+
+    printf("testcase %d: %d timesteps, %d ships, %d served, %d still docked, %ld messages, %ld errors\n",
+           tc, steps, numShips, served, docked, msgs, errors);
+    return errors > 0 ? EXIT_FAILURE : EXIT_SUCCESS;
+}
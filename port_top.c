@@ -0,0 +1,114 @@
+// Live view of the scheduler's metrics page (scheduler --metrics=<shm_key>).
+// Attaches read-only, so it never blocks or slows the scheduler.
+//
+// build: gcc -O2 -o port_top port_top.c
+// usage: ./port_top <shm_key> [interval_ms] [--once]
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <unistd.h>
+#include <sys/ipc.h>
+#include <sys/shm.h>
+#include "port_metrics.h"
+
+static double rate(int64_t now, int64_t before, double seconds) {
+    return seconds > 0 ? (now - before) / seconds : 0;
+}
+
+static void show(const PortMetrics *cur, const PortMetrics *prev) {
+    double seconds = prev ? (cur->publishedNs - prev->publishedNs) / 1e9 : 0;
+
+    printf("timestep %d%s | ships %d, serviced %d | steps/s %.1f\n",
+           cur->timestep, cur->finished ? " (finished)" : "", cur->totalShips, cur->servicedShips,
+           prev ? rate(cur->timesteps, prev->timesteps, seconds) : 0.0);
+
+    printf("\ndock cat  ship  dir  cranes  util%%  busy%%\n");
+    for (int i = 0; i < cur->numDocks && i < METRICS_MAX_DOCKS; i++) {
+        const DockMetrics *dm = &cur->docks[i];
+        double craneSteps = (double)dm->numCranes * cur->timesteps;
+        printf("%4d %3d  ", i, dm->category);
+        if (dm->occupied) {
+            printf("%4d  %3s", dm->shipId, dm->direction == 1 ? "in" : "out");
+        } else {
+            printf("%4s  %3s", "-", "-");
+        }
+        printf("  %2d/%-2d  %5.1f  %5.1f\n", dm->cranesUsed, dm->numCranes,
+               craneSteps > 0 ? 100.0 * dm->craneMoves / craneSteps : 0.0,
+               cur->timesteps > 0 ? 100.0 * dm->busySteps / cur->timesteps : 0.0);
+    }
+
+    printf("\nwaiting: %d emergency\n", cur->waitingEmergency);
+    printf("cat   in  out\n");
+    for (int c = 0; c <= METRICS_MAX_CATEGORY; c++) {
+        if (cur->waiting[c][0] || cur->waiting[c][1]) {
+            printf("%3d %4d %4d\n", c, cur->waiting[c][0], cur->waiting[c][1]);
+        }
+    }
+
+    printf("\nsolver  guesses/s   guesses      sent      recv\n");
+    for (int i = 0; i < cur->numSolvers && i < METRICS_MAX_SOLVERS; i++) {
+        printf("%6d %10.0f %9lld %9lld %9lld\n", i,
+               prev ? rate(cur->solverGuesses[i], prev->solverGuesses[i], seconds) : 0.0,
+               (long long)cur->solverGuesses[i], (long long)cur->solverSent[i],
+               (long long)cur->solverRecv[i]);
+    }
+
+    printf("\nauth searches %lld, by length:", (long long)cur->authSearches);
+    for (int l = 0; l < METRICS_AUTH_LEN_BUCKETS; l++) {
+        if (cur->authLenCount[l]) {
+            printf(" %d%s:%lld", l, l == METRICS_AUTH_LEN_BUCKETS - 1 ? "+" : "",
+                   (long long)cur->authLenCount[l]);
+        }
+    }
+    printf("\nmain queue: sent %lld, received %lld\n",
+           (long long)cur->mainSent, (long long)cur->mainRecv);
+    fflush(stdout);
+}
+
+int main(int argc, char *argv[]) {
+    if (argc < 2) {
+        fprintf(stderr, "usage: %s <shm_key> [interval_ms] [--once]\n", argv[0]);
+        exit(EXIT_FAILURE);
+    }
+    key_t key = (key_t)strtol(argv[1], NULL, 0);
+    int intervalMs = 1000;
+    int once = 0;
+    for (int i = 2; i < argc; i++) {
+        if (strcmp(argv[i], "--once") == 0) {
+            once = 1;
+        } else {
+            intervalMs = atoi(argv[i]);
+        }
+    }
+
+    int shmid = shmget(key, sizeof(PortMetrics), 0);
+    if (shmid == -1) {
+        perror("error connecting to metrics shared memory");
+        exit(EXIT_FAILURE);
+    }
+    const PortMetrics *pm = (const PortMetrics *)shmat(shmid, NULL, SHM_RDONLY);
+    if (pm == (void *)-1) {
+        perror("error attaching metrics shared memory");
+        exit(EXIT_FAILURE);
+    }
+
+    PortMetrics snap[2];
+    int cur = 0;
+    bool havePrev = false;
+    for (;;) {
+        metrics_read(pm, &snap[cur]);
+        if (!once) {
+            printf("\033[H\033[2J");
+        }
+        show(&snap[cur], havePrev ? &snap[cur ^ 1] : NULL);
+        if (once || snap[cur].finished) {
+            break;
+        }
+        havePrev = true;
+        cur ^= 1;
+        usleep(intervalMs * 1000);
+    }
+    shmdt(pm);
+    return 0;
+}
@@ -0,0 +1,141 @@
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include "sched_policy.h"
+
+// serviced ships last, then waiting before docked, emergencies first;
+// callers have already tied two serviced ships
+static int cmp_status(const Ship *sa, const Ship *sb) {
+    if (sa->status==2 && sb->status!=2)
+        return 1;
+    if (sb->status==2 && sa->status!=2)
+        return -1;
+
+    if (sa->status!=sb->status) {
+        return sa->status-sb->status;
+    }
+
+    if (sa->emergency!=sb->emergency) {
+        return sb->emergency-sa->emergency;
+    }
+    return 0;
+}
+
+//comparison function for sorting ships by priority
+int default_compare(const Ship *sa, const Ship *sb, int now) {
+    if (sa->status==2 && sb->status==2)
+        return 0;
+    int k = cmp_status(sa, sb);
+    if (k != 0) {
+        return k;
+    }
+
+    if (sa->emergency==0 && sb->emergency==0 && sa->direction==1 && sb->direction==1) {
+        int remainingA = (sa->arrivalTimestep + sa->waitingTime) - now;
+        int remainingB = (sb->arrivalTimestep + sb->waitingTime) - now;
+        if (remainingA!=remainingB) {
+            return remainingA-remainingB;
+        }
+    }
+    if (sa->direction!=sb->direction) {
+        return sb->direction-sa->direction;
+    }
+    return sa->arrivalTimestep-sb->arrivalTimestep;
+}
+
+// emergencies: smallest compatible category; others: exact category match
+// first, then the smallest category that still fits
+int default_choose_dock(const Dock *docks, int numDocks, const Ship *ship) {
+    if (ship->emergency != 1) {
+        for (int i = 0; i < numDocks; i++) {
+            if (dock_available(&docks[i], ship) && docks[i].category == ship->category) {
+                return i;
+            }
+        }
+    }
+
+    int bestDock = -1;
+    int minCategory = POLICY_MAX_CATEGORY + 1;
+    for (int i = 0; i < numDocks; i++) {
+        if (dock_available(&docks[i], ship) && docks[i].category >= ship->category
+            && docks[i].category < minCategory) {
+            minCategory = docks[i].category;
+            bestDock = i;
+        }
+    }
+    return bestDock;
+}
+
+// shortest job first: fewest cargo items left, so docks turn over quickly;
+// ignores how close regular ships are to their waiting time
+static int sjf_compare(const Ship *sa, const Ship *sb, int now) {
+    if (sa->status==2 && sb->status==2)
+        return 0;
+    int k = cmp_status(sa, sb);
+    if (k != 0) {
+        return k;
+    }
+    int leftA = sa->numCargo - sa->cargoProcessed;
+    int leftB = sb->numCargo - sb->cargoProcessed;
+    if (leftA != leftB) {
+        return leftA - leftB;
+    }
+    return default_compare(sa, sb, now);
+}
+
+// lowest-numbered free dock the ship fits
+static int first_fit_dock(const Dock *docks, int numDocks, const Ship *ship) {
+    for (int i = 0; i < numDocks; i++) {
+        if (dock_available(&docks[i], ship) && docks[i].category >= ship->category) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+// lowest-numbered free crane that can lift the weight
+static int first_fit_crane(const CraneSet *cranes, int weight) {
+    for (int i = 0; i < CRANE_LANES; i++) {
+        if (cranes->usable[i] && cranes->capacity[i] >= weight) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+static const SchedPolicy defaultPolicy = {
+    "default", "deadline order, best-fit dock and crane, emergency > regular > outgoing",
+    default_compare, default_choose_dock, crane_select_best,
+    { PASS_EMERGENCY, PASS_REGULAR, PASS_OUTGOING }, true
+};
+
+static const SchedPolicy outFirstPolicy = {
+    "out-first", "default, but outgoing ships dock before regular incoming ones",
+    default_compare, default_choose_dock, crane_select_best,
+    { PASS_EMERGENCY, PASS_OUTGOING, PASS_REGULAR }, true
+};
+
+static const SchedPolicy sjfPolicy = {
+    "sjf", "fewest cargo items first, best-fit dock and crane",
+    sjf_compare, default_choose_dock, crane_select_best,
+    { PASS_EMERGENCY, PASS_REGULAR, PASS_OUTGOING }, false
+};
+
+static const SchedPolicy firstFitPolicy = {
+    "first-fit", "deadline order, first free dock and crane that fit",
+    default_compare, first_fit_dock, first_fit_crane,
+    { PASS_EMERGENCY, PASS_REGULAR, PASS_OUTGOING }, true
+};
+
+const SchedPolicy *const schedPolicies[] = {
+    &defaultPolicy, &outFirstPolicy, &sjfPolicy, &firstFitPolicy, NULL
+};
+
+const SchedPolicy *policy_find(const char *name) {
+    for (int i = 0; schedPolicies[i]; i++) {
+        if (strcmp(schedPolicies[i]->name, name) == 0) {
+            return schedPolicies[i];
+        }
+    }
+    return NULL;
+}
@@ -0,0 +1,93 @@
+#ifndef SCHED_POLICY_H
+#define SCHED_POLICY_H
+
+#include <stdbool.h>
+#include "crane_select.h"
+
+// Scheduling policies (--policy=<name>). A policy makes the three choices
+// the scheduler used to hard-wire: the order waiting ships are considered
+// in, which free dock a ship gets and which crane moves each cargo item,
+// plus the order of the docking passes within a timestep. "default" is
+// the original behavior. Policies only see the dock and ship tables; the
+// scheduler keeps the protocol (messages, auth, waiting-time expiry).
+
+#define MAX_CARGO_COUNT 200
+#define POLICY_MAX_CATEGORY 25   // MAX_CATEGORY
+
+ typedef struct Dock {
+    int id;
+    int category;
+    CraneSet cranes;    // capacities + free-crane mask
+    int numCranes;
+    bool isOccupied;
+    int occupiedByShipId;
+    int occupiedByDirection;
+    int dockingTimestep;
+    int lastCargoMovedTimestep;
+    bool cargoFullyMoved;
+    int reserved;       // --reserve: RESERVE_NONE, RESERVE_SPARE or RESERVE_HELD this timestep
+} Dock;
+
+#define RESERVE_NONE 0
+#define RESERVE_SPARE 1     // other ships get it only when no unreserved free dock fits them
+#define RESERVE_HELD 2      // emergencies only: one is expected before it would free up again
+
+//structure to hold ship info
+typedef struct Ship {
+    int id;
+    int direction;
+    int category;
+    int emergency;
+    int waitingTime;
+    int arrivalTimestep;
+    int firstArrival;   // arrivalTimestep of its first request, for turnaround
+    int numCargo;
+    int cargo[MAX_CARGO_COUNT];
+    int cargoProcessed;
+    int dockId;
+    int status;
+    int leaveTimestep;
+    int rank;           // position in shipOrder after this step's sort
+    int deadline;       // arrivalTimestep + waitingTime, set while in the wait wheel
+    int wheelSlot;      // WHEEL_NONE, WHEEL_OVERFLOW or slot index
+    struct Ship *wheelPrev;
+    struct Ship *wheelNext;
+    int hashNext;       // slot + 1 of the next ship in its find_ship bucket, 0 at the end
+    bool ordered;       // listed in shipOrder
+} Ship;
+
+// free, and not held back from this ship; every choose_dock checks this
+static inline bool dock_available(const Dock *dock, const Ship *ship) {
+    return !dock->isOccupied && (dock->reserved == RESERVE_NONE || ship->emergency == 1);
+}
+
+// docking passes, run in SchedPolicy.passes order every timestep
+#define PASS_EMERGENCY 0
+#define PASS_REGULAR 1      // regular incoming ships still within their waiting time
+#define PASS_OUTGOING 2
+#define NUM_PASSES 3
+
+typedef struct SchedPolicy {
+    const char *name;
+    const char *description;
+    // < 0 if a is offered a dock before b at timestep now; the sort is stable
+    int (*compare)(const Ship *a, const Ship *b, int now);
+    // index of an available dock for ship among docks[0..numDocks), -1 to keep it waiting
+    int (*choose_dock)(const Dock *docks, int numDocks, const Ship *ship);
+    // free crane in cranes that can lift weight, -1 if none
+    int (*choose_crane)(const CraneSet *cranes, int weight);
+    int passes[NUM_PASSES];
+    // compare puts regular incoming ships in deadline order, so the regular
+    // pass can walk the wait wheel instead of the whole ship order
+    bool deadlineFirst;
+} SchedPolicy;
+
+extern const SchedPolicy *const schedPolicies[];   // NULL terminated, default first
+
+const SchedPolicy *policy_find(const char *name);
+
+// the default policy's pieces, for policies that only change one of them
+int default_compare(const Ship *a, const Ship *b, int now);
+int default_choose_dock(const Dock *docks, int numDocks, const Ship *ship);
+
+#endif
@@ -1,3 +1,4 @@
+#define _GNU_SOURCE
 #include <stdio.h>
 #include <sys/ipc.h>
 #include <sys/msg.h>
@@ -10,15 +11,55 @@
 #include <limits.h>
 #include <stdbool.h>
 #include <time.h>
+#include <errno.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <sys/mman.h>
+#include <malloc.h>
+#include <sys/resource.h>
+#include <semaphore.h>
+#include <sched.h>
+#include "ipc_transport.h"
+#include "crane_select.h"
+#include "auth_model.h"
+#include "port_metrics.h"
+#include "arena.h"
+#ifdef ALLOC_CHECK
+#include "alloc_guard.h"
+#else
+// only ALLOC_CHECK builds link the malloc interposer (alloc_guard.c)
+static inline void alloc_guard_arm(void) {}
+static inline void alloc_guard_disarm(void) {}
+static inline long alloc_guard_count(void) { return 0; }
+#endif
+#include "cpu_topology.h"
+#include "sched_policy.h"
 
 
-#define MAX_CARGO_COUNT 200
 #define MAX_AUTH_STRING_LEN 100
 #define MAX_NEW_REQUESTS 100
 #define MAX_SOLVERS 8
 #define MAX_CATEGORY 25
 #define MAX_DOCKS 30
 #define MAX_SHIP_REQUESTS 1100  
+#define SHIP_HASH_BUCKETS 2048   // power of two, find_ship's index over the ship table
+#define WAIT_WHEEL_SLOTS 256     // power of two, deadlines further out go to overflow
+#define WHEEL_NONE -2
+#define WHEEL_OVERFLOW -1
+#define STEP_ARENA_SIZE (1 << 20)
+#define SOLVER_ARENA_SIZE 4096
+#define MAX_PORTS 128
+#define MAX_POOL_THREADS 64
+#define DEFAULT_PORT_WORKERS 8    // workers mostly wait on solver round trips, not cpu
+#define PORT_POLL_MIN_US 50       // port worker backoff when no port has a timestep ready
+#define PORT_POLL_MAX_US 2000
+#define MAX_EVAL_POLICIES 8
+#define GEN_DEFAULT_STEPS 10000   // --evaluate=gen:<seed> without a step count
+#define GEN_SOLVERS 2
+#define GEN_DEFAULT_LOAD 80       // new ships per 100 timesteps, at most 300
+#define EMG_WAIT_BUCKETS 256      // emergency wait histogram; the last bucket counts everything longer
+#define SHADOW_QUEUE_STEPS 8      // live timesteps a shadow may fall behind before it is stopped
+#define EMG_RATE_WINDOW 32        // --reserve: timesteps the emergency arrival rate averages over
 
 
 typedef struct ShipRequest {
@@ -62,64 +103,224 @@ typedef struct SolverResponse {
     int guessIsCorrect;
 } SolverResponse;
 
- typedef struct Dock {
-    int id;
-    int category;
-    int craneCapacities[MAX_CATEGORY];
-    int numCranes;
-    bool isOccupied;
-    int occupiedByShipId;
-    int occupiedByDirection;
-    int dockingTimestep;
-    int lastCargoMovedTimestep;
-    bool cargoFullyMoved;
-    bool craneUsed[MAX_CATEGORY];
-} Dock;
-
-//structure to hold ship info
-typedef struct Ship {
-    int id;
-    int direction;     
-    int category;
-    int emergency;     
-    int waitingTime;
-    int arrivalTimestep;
-    int numCargo;
-    int cargo[MAX_CARGO_COUNT];
-    int cargoProcessed;
-    int dockId;
-    int status;        
-    int leaveTimestep; 
-} Ship;
+// Message buffers of one solver queue's worker, a page each so --pin can
+// put them on the NUMA node of the cpu that worker runs on.
+typedef struct SolverScratch {
+    _Alignas(4096) SolverRequest request;
+    SolverResponse response;
+} SolverScratch;
+
+// timing wheel of waiting regular incoming ships, bucketed by deadline.
+// Slot (d & mask) only ever holds deadline d for d in [now, now + slots).
+typedef struct WaitWheel {
+    Ship *slots[WAIT_WHEEL_SLOTS];
+    Ship *overflow;
+    int now;            // smallest deadline still live
+    int inSlots;
+} WaitWheel;
 
 typedef struct Thr_data {
-    int solverMsgid;        
-    int startIndex;         
-    int endIndex;           
-    char **guesses;         
+    Transport *solverQueue; 
+    SolverScratch *scratch; 
+    long long startIndex;   
+    long long endIndex;     
+    int stride;             
+    int guessesSent;        
+    int msgsSent;           
+    int msgsRecv;           
+    Arena *arena;           
+    const AuthOrder *order; 
     char *correctGuess;     
     int length;             
     bool *found;            
     int dockId;             
     pthread_mutex_t *mutex; 
+    int *running;           // solver pool: tasks of this search not done yet
+    pthread_cond_t *done;   
+    struct Thr_data *next;  
 } Thr_data;
 
+// Multi-port mode: the auth searches of every port run on one fixed set of
+// threads instead of a fresh thread per solver queue and search.
+typedef struct SolverPool {
+    pthread_mutex_t lock;
+    pthread_cond_t ready;
+    Thr_data *head, *tail;      // pending tasks, linked through next
+    pthread_t threads[MAX_POOL_THREADS];
+    int numThreads;             // 0 outside multi-port mode
+    bool stopping;
+} SolverPool;
+
 typedef struct {
     int dockId;
     int status;
 } datastatus;
 
 
-MainSharedMemory *sharedMemory;
-Dock docks[MAX_DOCKS];
-Ship ships[MAX_SHIP_REQUESTS];
-int n;
-int nships = 0;
-int curr_timestep = 1;
-int solver_ids[MAX_SOLVERS];
-int m;
-int shmid, mqid;
+typedef struct Docking {
+    int shipId;
+    int direction;
+    int dockId;
+} Docking;
+
+// --shadow: how the shadow's decisions compared with the live port's
+// what the shadow report prints of a port, as of some timestep
+typedef struct PortTotals {
+    long long shipsServed, deadlineMisses, turnaroundSum, authGuesses;
+    long long authNs;
+    long long emgDocked;
+    int emgWait[EMG_WAIT_BUCKETS];
+} PortTotals;
+
+typedef struct ShadowStats {
+    int steps;
+    int diffSteps;              // timesteps where the two docked differently
+    int firstDiff;
+    long long diffDecisions;    // dockings only one of them made
+    long long primaryDockings, shadowDockings;
+    long long primaryNs;        // live timestep handling, shadow intake included
+    long long pathNs;           // shadow intake on the live thread
+    long long shadowNs;         // shadow timesteps on the shadow thread
+    int stoppedAt;              // live timestep the shadow fell too far behind at, 0 if never
+    PortTotals liveAtStop;      // the live port after the last timestep the shadow got
+} ShadowStats;
+
+// --shadow: one live timestep, copied out before it is acknowledged, as
+// the shadow thread replays it
+typedef struct ShadowStep {
+    int timestep;
+    bool finished;
+    int numDockings;
+    Docking dockings[MAX_DOCKS];                        // the live port's
+    long long authLenCount[METRICS_AUTH_LEN_BUCKETS];   // the live port's searches so far
+    long long authLenGuesses[METRICS_AUTH_LEN_BUCKETS];
+    int numRequests;
+    ShipRequest requests[MAX_NEW_REQUESTS];
+} ShadowStep;
+
+// single producer (whoever runs the live port), single consumer (the shadow thread)
+typedef struct ShadowQueue {
+    _Atomic unsigned head, tail;
+    ShadowStep steps[SHADOW_QUEUE_STEPS];
+} ShadowQueue;
+
+// Everything one scheduled port owns. A process runs one port, or with
+// several testcases many of them over a shared worker and solver pool.
+typedef struct Port {
+    int tc;
+    MainSharedMemory *sharedMemory;
+    int shmid;
+    Transport mainQueue;
+    Transport solverQueues[MAX_SOLVERS];
+    SolverScratch solverScratch[MAX_SOLVERS];
+    int m;
+    Dock docks[MAX_DOCKS];
+    int n;
+    Ship ships[MAX_SHIP_REQUESTS];        // stable storage, never reordered
+    int nships;                           // slots of ships used so far
+    int shipHash[SHIP_HASH_BUCKETS];      // slot + 1 of a bucket's newest ship, 0 when empty
+    int servicedSlots;                    // slots holding a serviced ship
+    Ship *shipOrder[MAX_SHIP_REQUESTS];   // waiting ships that may dock, sorted by the policy every step
+    Ship *sortScratch[MAX_SHIP_REQUESTS];
+    int numOrdered;
+    int curr_timestep;
+    WaitWheel waitWheel;
+    Arena *stepArena;                     // per-timestep scratch, reset in timestep_inc; owned
+                                          // by whoever runs the timestep, not the port
+    Arena solverArenas[MAX_SOLVERS];      // one per solver worker
+    PortMetrics *metrics;                 // live telemetry page when set
+    int metricsShmid;
+    long long authSearches;
+    long long authGuesses;
+    long long ipcMainSent, ipcMainRecv;
+    long long solverGuesses[MAX_SOLVERS], solverSent[MAX_SOLVERS], solverRecv[MAX_SOLVERS];
+    long long authLenCount[METRICS_AUTH_LEN_BUCKETS];
+    long long authLenGuesses[METRICS_AUTH_LEN_BUCKETS];
+    long long shipsServed, turnaroundSum, deadlineMisses, shipsDropped;
+    int stepsDone;
+    const SchedPolicy *policy;
+    bool offline;                         // no validator or solvers: nothing is sent and auth
+                                          // searches are simulated (policy evaluator)
+    unsigned authSeed;                    // offline: picks where each simulated search hits
+    int reuseCursor;                      // next slot alloc_ship checks once the table is full
+    Docking dockings[MAX_DOCKS];          // ships docked this timestep, when shadowed or offline
+    int numDockings;
+    struct Port *shadow;                  // --shadow: offline copy fed the same requests
+    struct Port *primary;                 // on a shadow: the live port it follows
+    ShadowQueue *shadowQueue;             // on the live port: timesteps the shadow has yet to run
+    ShadowStats shadowStats;              // on the live port
+    long long liveLenCount[METRICS_AUTH_LEN_BUCKETS];    // on a shadow: the live port's auth
+    long long liveLenGuesses[METRICS_AUTH_LEN_BUCKETS];  // searches as of the step it runs
+    long long authNs;                     // shadowed: time spent in auth searches
+    int reserve;                          // --reserve: docks held back for emergency ships
+    int reserveHorizon;                   // occupied docks undocking within this many timesteps count
+    int emgArrivals;                      // --reserve: new emergency ships this timestep
+    double emgRate;                       // --reserve: emergency arrivals per timestep, moving average
+    int spareDocks;                       // --reserve: docks marked RESERVE_SPARE this timestep
+    long long heldSteps;                  // --reserve: timesteps a free dock was held for emergencies
+    int timesteps;
+    long long regularServed, emgDocked;
+    int emgWait[EMG_WAIT_BUCKETS];        // timesteps emergency ships waited for a dock
+    bool finished;
+    _Atomic int claimed;                  // multi-port: a worker is running this port
+} Port;
+
+// --evaluate: a port's ship arrivals without validation. Recorded ones
+// (--record) are replayed as they came; generated ones bring back ships
+// whose waiting time ran out, as validation does, so they react to the
+// policy being evaluated.
+typedef struct Workload {
+    int n, m;
+    Dock docks[MAX_DOCKS];
+    int endTimestep;            // the timestep validation would report the end at
+    ShipRequest *requests;      // recorded, in timestep order
+    int numRequests;
+    int next;                   // replay position
+    bool generated;
+    unsigned seed;
+    int maxCategory;            // generated: largest dock category
+    int liftLimit[MAX_CATEGORY + 1];  // generated: heaviest item every dock a ship of the category fits can lift
+    int load;                   // generated: new ships per 100 timesteps
+    unsigned rng;               // generator state, reset per policy
+    int nextShipId;
+} Workload;
+
+int ipcKind = IPC_SYSV;
+AuthModel authModel;
+const char *authModelPath = NULL;   // learning mode when set
+FILE *authModelLog = NULL;
+pthread_rwlock_t authModelLock = PTHREAD_RWLOCK_INITIALIZER;
+int allocCheckWarmup = 0;            // --alloc-check: timesteps before the guard arms
+_Atomic int portsWarm = 0;
+Port *ports[MAX_PORTS];
+int numPorts = 0;
+_Atomic int portsLeft = 0;
+int portWorkers = 0;
+SolverPool solverPool = { .lock = PTHREAD_MUTEX_INITIALIZER, .ready = PTHREAD_COND_INITIALIZER };
+CpuTopology topology;
+bool pinning = false;                // --pin
+int pinPlan[2 * MAX_POOL_THREADS];   // main loop or port workers first, then solver workers
+pthread_attr_t solverAttr[MAX_SOLVERS];   // single-port: solver queue i's worker on its cpu
 int sid;
+const SchedPolicy *policies[MAX_EVAL_POLICIES];   // --policy; a live port runs the first
+int numPolicies = 0;
+FILE *recordFile = NULL;             // --record
+FILE *shadowDiffFile = NULL;         // --shadow-diff
+pthread_t shadowThread;              // --shadow: runs every port's shadow
+sem_t shadowWake;                    // posted once per queued shadow step
+_Atomic bool shadowStopping = false;
+long long shadowCpuNs = 0;           // the shadow thread's cpu time, once it has stopped
+int reserveCount = 0;                // --reserve
+int reserveHorizon = 1;
+int shadowReserve = 0;               // --shadow-reserve
+int shadowReserveHorizon = 1;
+MainSharedMemory evalMemory;         // request buffer of offline ports
+
+long long now_ns() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
 
 
 //debugging error
@@ -141,25 +342,179 @@ void logIPCUsage(int msgCount, int shmReads, int shmWrites) {
 }
 
 
+static inline int ship_bucket(int shipId, int dirn) {
+    return ((unsigned)shipId * 2654435761u + (dirn == 1)) & (SHIP_HASH_BUCKETS - 1);
+}
+
 // Find a ship by its ID and direction
-Ship* find_ship(int shipId, int dirn) {
-    for (int i = 0; i < nships; i++) {
-        if (ships[i].id == shipId && ships[i].direction == dirn) {
-            return &ships[i];
+Ship* find_ship(Port *port, int shipId, int dirn) {
+    for (int slot = port->shipHash[ship_bucket(shipId, dirn)]; slot; slot = port->ships[slot - 1].hashNext) {
+        Ship *ship = &port->ships[slot - 1];
+        if (ship->id == shipId && ship->direction == dirn) {
+            return ship;
+        }
+    }
+    return NULL;
+}
+
+void ship_hash_insert(Port *port, Ship *ship) {
+    int *head = &port->shipHash[ship_bucket(ship->id, ship->direction)];
+    ship->hashNext = *head;
+    *head = ship - port->ships + 1;
+}
+
+void ship_hash_remove(Port *port, Ship *ship) {
+    int *link = &port->shipHash[ship_bucket(ship->id, ship->direction)];
+    while (*link != ship - port->ships + 1) {
+        link = &port->ships[*link - 1].hashNext;
+    }
+    *link = ship->hashNext;
+}
+
+// can dock this timestep: waiting, and for a regular incoming ship still
+// within its waiting time
+static inline bool ship_eligible(const Ship *ship) {
+    return ship->status == 0 && (ship->emergency == 1 || ship->direction == -1 || ship->wheelSlot != WHEEL_NONE);
+}
+
+// append a ship that became eligible to the ship order; the next sort puts
+// it in place
+void order_ship(Port *port, Ship *ship) {
+    if (!ship->ordered && ship_eligible(ship)) {
+        ship->ordered = true;
+        port->shipOrder[port->numOrdered++] = ship;
+    }
+}
+
+// drop the ships that docked or ran out of waiting time since the last sort
+void prune_ship_order(Port *port) {
+    int k = 0;
+    for (int i = 0; i < port->numOrdered; i++) {
+        Ship *ship = port->shipOrder[i];
+        if (ship_eligible(ship)) {
+            port->shipOrder[k++] = ship;
+        } else {
+            ship->ordered = false;
+        }
+    }
+    port->numOrdered = k;
+}
+
+Ship **wheel_list(Port *port, int slot) {
+    return slot == WHEEL_OVERFLOW ? &port->waitWheel.overflow : &port->waitWheel.slots[slot];
+}
+
+void wheel_remove(Port *port, Ship *ship) {
+    if (ship->wheelSlot == WHEEL_NONE) {
+        return;
+    }
+    if (ship->wheelPrev) {
+        ship->wheelPrev->wheelNext = ship->wheelNext;
+    } else {
+        *wheel_list(port, ship->wheelSlot) = ship->wheelNext;
+    }
+    if (ship->wheelNext) {
+        ship->wheelNext->wheelPrev = ship->wheelPrev;
+    }
+    if (ship->wheelSlot != WHEEL_OVERFLOW) {
+        port->waitWheel.inSlots--;
+    }
+    ship->wheelSlot = WHEEL_NONE;
+}
+
+// (re)queue a waiting regular incoming ship under its current deadline
+void wheel_insert(Port *port, Ship *ship) {
+    wheel_remove(port, ship);
+    ship->deadline = ship->arrivalTimestep + ship->waitingTime;
+    if (ship->deadline < port->waitWheel.now) {
+        return;  // already past its waiting time
+    }
+
+    int slot = WHEEL_OVERFLOW;
+    if (ship->deadline - port->waitWheel.now < WAIT_WHEEL_SLOTS) {
+        slot = ship->deadline & (WAIT_WHEEL_SLOTS - 1);
+        port->waitWheel.inSlots++;
+    }
+    Ship **head = wheel_list(port, slot);
+    ship->wheelSlot = slot;
+    ship->wheelPrev = NULL;
+    ship->wheelNext = *head;
+    if (*head) {
+        (*head)->wheelPrev = ship;
+    }
+    *head = ship;
+}
+
+// drop every ship whose deadline is before now, pull in overflow ships
+// that came within the horizon
+void wheel_advance(Port *port, int now) {
+    if (now <= port->waitWheel.now) {
+        return;
+    }
+    int expired = now - port->waitWheel.now;
+    if (expired > WAIT_WHEEL_SLOTS) {
+        expired = WAIT_WHEEL_SLOTS;
+    }
+    for (int d = 0; d < expired; d++) {
+        Ship **head = &port->waitWheel.slots[(port->waitWheel.now + d) & (WAIT_WHEEL_SLOTS - 1)];
+        while (*head) {
+            wheel_remove(port, *head);
+            port->deadlineMisses++;
+        }
+    }
+    port->waitWheel.now = now;
+
+    Ship *ship = port->waitWheel.overflow;
+    while (ship) {
+        Ship *next = ship->wheelNext;
+        if (ship->deadline < now) {
+            port->deadlineMisses++;
+        }
+        if (ship->deadline - now < WAIT_WHEEL_SLOTS) {
+            wheel_insert(port, ship);
+        }
+        ship = next;
+    }
+}
+// Slot for a new ship: the next unused one, and once the table is full the
+// slot of a ship that has already left, so long runs keep going. NULL when
+// every slot holds a ship still waiting or docked.
+Ship *alloc_ship(Port *port) {
+    if (port->nships < MAX_SHIP_REQUESTS) {
+        return &port->ships[port->nships++];
+    }
+    for (int i = 0; i < MAX_SHIP_REQUESTS; i++) {
+        int slot = (port->reuseCursor + i) % MAX_SHIP_REQUESTS;
+        if (port->ships[slot].status == 2) {
+            port->reuseCursor = slot + 1;
+            ship_hash_remove(port, &port->ships[slot]);
+            port->servicedSlots--;
+            return &port->ships[slot];
         }
     }
     return NULL;
 }
-void new_ship_req(int nreq) {
+
+void new_ship_req(Port *port, int nreq) {
     int i = 0;
     while(i < nreq){
-        ShipRequest req = sharedMemory->newShipRequests[i];
+        ShipRequest req = port->sharedMemory->newShipRequests[i];
        
         // Check if this is a returning ship
-        Ship *existingShip = find_ship(req.shipId, req.direction);
+        Ship *existingShip = find_ship(port, req.shipId, req.direction);
+        if (port->offline && existingShip != NULL && existingShip->status != 0) {
+            // validation re-sent a ship that this port, unlike the one
+            // validation follows, has already docked
+            i++;
+            continue;
+        }
         if (existingShip != NULL && existingShip->status == 0) {
             // Update the existing ship's arrival timestep
             existingShip->arrivalTimestep = req.timestep;
+            if (existingShip->direction == 1 && existingShip->emergency == 0) {
+                wheel_insert(port, existingShip);
+            }
+            order_ship(port, existingShip);
             i++;
             continue;
         }
@@ -174,8 +529,10 @@ void new_ship_req(int nreq) {
         newShip.waitingTime = req.waitingTime;
         newShip.emergency = req.emergency;
         newShip.arrivalTimestep = req.timestep;
+        newShip.firstArrival = req.timestep;
         newShip.cargoProcessed = 0;
         newShip.status = 0;  //waiting
+        newShip.wheelSlot = WHEEL_NONE;
        
         //cargo weights copied
         int j = 0;
@@ -184,7 +541,23 @@ void new_ship_req(int nreq) {
             j++;
         }
        
-        ships[nships++] = newShip;
+        Ship *ship = alloc_ship(port);
+        if (ship == NULL) {
+            if (!port->offline) {
+                fprintf(stderr, "ship table full, dropping ship %d\n", newShip.id);
+            }
+            port->shipsDropped++;
+            i++;
+            continue;
+        }
+        newShip.ordered = ship->ordered;
+        *ship = newShip;
+        ship_hash_insert(port, ship);
+        if (ship->direction == 1 && ship->emergency == 0) {
+            wheel_insert(port, ship);
+        }
+        order_ship(port, ship);
+        port->emgArrivals += ship->emergency == 1;
         i++;
     }
 }
@@ -215,38 +588,32 @@ int cargo_mass_op(int d_id, ShipRequest *ship) {
     return gms;
 }
 
-//comparison function for sorting ships by priority
-int cmp_ships(const void *a, const void *b) {
-    const Ship *sa = (const Ship *)a;
-    const Ship *sb = (const Ship *)b;
-   
-    if (sa->status==2 && sb->status!=2) 
-        return 1;
-    if (sa->status==2 && sb->status==2) 
-        return 0;
-    if (sb->status==2 && sa->status!=2) 
-        return -1;
-   
-    if (sa->status!=sb->status) {
-        return sa->status-sb->status;
-    }
-   
-    if (sa->emergency!=sb->emergency) {
-        return sb->emergency-sa->emergency;
-    }
-   
-    if (sa->emergency==0 && sb->emergency==0 && sa->direction==1 && sb->direction==1) {
-        int remainingA = (sa->arrivalTimestep + sa->waitingTime) - curr_timestep;
-        int remainingB = (sb->arrivalTimestep + sb->waitingTime) - curr_timestep;
-        if (remainingA!=remainingB) {
-            int k =remainingA-remainingB;
-            return k;//debugged till here
+// stable bottom-up merge sort of the ship order; qsort may allocate a
+// scratch buffer on every call and need not be stable
+void sort_ships(Port *port) {
+    Ship **order = port->shipOrder, **scratch = port->sortScratch;
+    int count = port->numOrdered;
+    for (int width = 1; width < count; width *= 2) {
+        for (int lo = 0; lo < count; lo += 2 * width) {
+            int mid = lo + width < count ? lo + width : count;
+            int hi = lo + 2 * width < count ? lo + 2 * width : count;
+            int a = lo, b = mid, out = lo;
+            while (a < mid && b < hi) {
+                if (port->policy->compare(order[b], order[a], port->curr_timestep) < 0) {
+                    scratch[out++] = order[b++];
+                } else {
+                    scratch[out++] = order[a++];
+                }
+            }
+            while (a < mid) {
+                scratch[out++] = order[a++];
+            }
+            while (b < hi) {
+                scratch[out++] = order[b++];
+            }
         }
+        memcpy(order, scratch, count * sizeof(Ship *));
     }
-    if (sa->direction!=sb->direction) {
-        return sb->direction-sa->direction;
-    }
-    return sa->arrivalTimestep-sb->arrivalTimestep;
 }
 
 //debugging error
@@ -265,59 +632,31 @@ void dock_locking(){
 }
 
 
-int calc_optDock(Ship *ship) {
-    if (ship->emergency == 1) {
-        int bestDock= -1;
-        int minCategory= MAX_CATEGORY + 1;
-        int i=0;
-
-        if (n>0){
-            do{
-                if(!docks[i].isOccupied && docks[i].category>=ship->category) {
-                    if (docks[i].category < minCategory) {
-                        minCategory= docks[i].category;
-                        bestDock= i;
-                    }
-                }
-                i++;
-            }while(i<n);
-        }
-
-        return bestDock;
+// Spare docks are the last resort: a ship only gets one when no
+// unreserved free dock fits it, so holding them costs no throughput.
+int calc_optDock(Port *port, Ship *ship) {
+    int dockId = port->policy->choose_dock(port->docks, port->n, ship);
+    if (dockId != -1 || port->spareDocks == 0 || ship->emergency == 1) {
+        return dockId;
     }
-
-    int i=0;
-    if (n>0){
-        do{
-            if(!docks[i].isOccupied && docks[i].category == ship->category){
-                return i;
-            }
-            i++;
-        }while(i<n);
+    bool spare[MAX_DOCKS];
+    for (int i = 0; i < port->n; i++) {
+        spare[i] = port->docks[i].reserved == RESERVE_SPARE;
+        if (spare[i]) {
+            port->docks[i].reserved = RESERVE_NONE;
+        }
     }
-
-    int bestDock= -1;
-    int minCategory= MAX_CATEGORY+1;
-    i=0;
-
-    if (n>0){
-        do{
-            if(!docks[i].isOccupied && docks[i].category >= ship->category){
-                if(docks[i].category < minCategory){
-                    minCategory= docks[i].category;
-                    bestDock= i;
-                }
-            }
-            i++;
-        }while(i < n);
+    dockId = port->policy->choose_dock(port->docks, port->n, ship);
+    for (int i = 0; i < port->n; i++) {
+        if (spare[i] && i != dockId) {
+            port->docks[i].reserved = RESERVE_SPARE;
+        }
     }
-
-    return bestDock;
+    port->spareDocks -= dockId != -1 && spare[dockId];
+    return dockId;
 }
 
- 
-
-void msg_to_val(int mtype, int shipId, int direction, int dockId, int cargoId, int craneId){
+void msg_to_val(Port *port, int mtype, int shipId, int direction, int dockId, int cargoId, int craneId){
     MessageStruct m;
     m.mtype= mtype;
     m.shipId= shipId;
@@ -325,40 +664,30 @@ void msg_to_val(int mtype, int shipId, int direction, int dockId, int cargoId, i
     m.dockId= dockId;
     m.craneId= craneId;
     m.cargoId= cargoId;
-    if (msgsnd(mqid,&m,sizeof(MessageStruct)-sizeof(long),0)== -1) {
+    if (mtype == 2 && (port->shadow || port->offline)) {
+        port->dockings[port->numDockings++] = (Docking){ shipId, direction, dockId };
+    }
+    if (port->offline) {
+        return;
+    }
+    if (transport_send(&port->mainQueue,&m,sizeof(MessageStruct)-sizeof(long))== -1) {
         perror("Error sending message to validation");
         exit(EXIT_FAILURE);
     }
+    port->ipcMainSent++;
 }
 //debugged till here
 
-void load_cargo(Ship *ship, Dock *dock) {
-    int count1 = 0;
-while (count1 < dock->numCranes) {
-    dock->craneUsed[count1] = false;
-    count1++;
-}  
+void load_cargo(Port *port, Ship *ship, Dock *dock) {
+crane_set_reset(&dock->cranes, dock->numCranes);
 int cargoIdx = ship->cargoProcessed;
 while (cargoIdx < ship->numCargo) {
     int cargoWeight = ship->cargo[cargoIdx];
-    int bestCraneIdx = -1; // find crane with capacity closest to cargo weight
-    int minWaste = INT_MAX;
-
-    int craneidx = 0;
-    while (craneidx < dock->numCranes) {
-        if (!dock->craneUsed[craneidx] && dock->craneCapacities[craneidx] >= cargoWeight) {
-            int waste = dock->craneCapacities[craneidx] - cargoWeight;
-            if (waste < minWaste) {
-                minWaste = waste;
-                bestCraneIdx = craneidx;
-            }
-        }
-        craneidx++;
-    }
+    int bestCraneIdx = port->policy->choose_crane(&dock->cranes, cargoWeight);
 
     if (bestCraneIdx != -1) {
-        dock->craneUsed[bestCraneIdx] = true;
-        msg_to_val(4, ship->id, ship->direction, dock->id, cargoIdx, bestCraneIdx);
+        crane_set_use(&dock->cranes, bestCraneIdx);
+        msg_to_val(port, 4, ship->id, ship->direction, dock->id, cargoIdx, bestCraneIdx);
         ship->cargoProcessed++;
         cargoIdx++;
     } else {
@@ -368,33 +697,18 @@ while (cargoIdx < ship->numCargo) {
 }
 
 
-void unload_cargo(Ship *ship, Dock *dock){
-    for (int i=0; i<dock->numCranes; i++) {
-        dock->craneUsed[i]=false;
-    }
+void unload_cargo(Port *port, Ship *ship, Dock *dock){
+    crane_set_reset(&dock->cranes, dock->numCranes);
     
     
     int cargoIdx = ship->cargoProcessed;
     while (cargoIdx < ship->numCargo) {
         int cargoWeight = ship->cargo[cargoIdx];
-        int bestCraneIdx = -1;
-        int minWaste = INT_MAX;
-    
-        int craneIdx = 0;
-        while (craneIdx < dock->numCranes) {
-            if (!dock->craneUsed[craneIdx] && dock->craneCapacities[craneIdx] >= cargoWeight) {
-                int waste = dock->craneCapacities[craneIdx] - cargoWeight;
-                if (waste < minWaste) {
-                    minWaste = waste;
-                    bestCraneIdx = craneIdx;
-                }
-            }
-            craneIdx++;
-        }
+        int bestCraneIdx = port->policy->choose_crane(&dock->cranes, cargoWeight);
     
         if (bestCraneIdx != -1) {
-            dock->craneUsed[bestCraneIdx] = true;  // use this crane to unload cargo
-            msg_to_val(4, ship->id, ship->direction, dock->id, cargoIdx, bestCraneIdx);
+            crane_set_use(&dock->cranes, bestCraneIdx);  // use this crane to unload cargo
+            msg_to_val(port, 4, ship->id, ship->direction, dock->id, cargoIdx, bestCraneIdx);
             ship->cargoProcessed++;
             cargoIdx++;
         } else {
@@ -404,21 +718,31 @@ void unload_cargo(Ship *ship, Dock *dock){
     }
 
 
-void timestep_inc() {
+void timestep_inc(Port *port) {
+    if (port->offline) {
+        arena_reset(port->stepArena);
+        return;
+    }
     MessageStruct message;
     message.mtype = 5;
-    if (msgsnd(mqid, &message, sizeof(MessageStruct) - sizeof(long), 0) == -1) {
+    if (transport_send(&port->mainQueue, &message, sizeof(MessageStruct) - sizeof(long)) == -1) {
         perror("Error sending message to validation");
         exit(EXIT_FAILURE);
     }
+    port->ipcMainSent++;
+
+    arena_reset(port->stepArena);
+    for (int i = 0; i < port->m; i++) {
+        arena_reset(&port->solverArenas[i]);
+    }
 }
  
-void crane_usage() {
-     for (int i = 0; i < n; i++) {
-        Dock *dock = &docks[i];
+void crane_usage(Port *port) {
+     for (int i = 0; i < port->n; i++) {
+        Dock *dock = &port->docks[i];
         int used = 0;
         for (int j = 0; j < dock->numCranes; j++) {
-            if (dock->craneUsed[j]) {
+            if (crane_set_is_used(&dock->cranes, j)) {
                 used++;
             }
         }
@@ -430,90 +754,23 @@ void crane_usage() {
 
 
 
-char **gen_authString(int length, int *totalCount) {
-     long long total = 5;  
-   
-     for (int i = 1; i < length - 1; i++) {
-        total *= 6;
-    }
-   
-     if(length > 1){
-        total *= 5;
-     }
-    *totalCount = (int)total;
-     char **allStrings = (char **)malloc(total * sizeof(char *));
-    if (!allStrings) {
-        perror("Memory allocation failed");
-        exit(EXIT_FAILURE);
-    }
-   
-    for (int i = 0; i < total; i++) {
-        allStrings[i] = (char *)malloc((length + 1) * sizeof(char));
-        if (!allStrings[i]) {
-            perror("Memory allocation failed");
-            exit(EXIT_FAILURE);
-        }
-    }
-    char validChars[] = "56789.";
-    char validEndChars[] = "56789"; 
-   
-    int index = 0;
-   
-     if (length == 1) {
-         for (int i = 0; i < 5; i++) {
-            allStrings[index][0] = validEndChars[i];
-            allStrings[index][1] = '\0';
-            index++;
-        }
-    }
-    else{
-       
-        int counter = 0;
-        if (total > 0) {
-            do {
-                int tempCounter = counter;
-                allStrings[index][0] = validEndChars[tempCounter % 5];
-                tempCounter /= 5;
-        
-                int pos = 1;
-                if (length - 1 > 1) {
-                    do {
-                        allStrings[index][pos] = validChars[tempCounter % 6];
-                        tempCounter /= 6;
-                        pos++;
-                    } while (pos < length - 1);
-                }
-        
-                if (length > 1) {
-                    allStrings[index][length - 1] = validEndChars[tempCounter % 5];
-                }
-        
-                allStrings[index][length] = '\0';
-                index++;
-                counter++;
-            } while (counter < total);
-        }
-            }
-   
-    return allStrings;
-}
-
-
-
  void *authStringThreadFunc(void *arg) {
     Thr_data *data = (Thr_data *)arg;
-    int mqid = data->solverMsgid;
+    Transport *solverQueue = data->solverQueue;
 
-     SolverRequest request;
-    request.mtype = 1;
-    request.dockId = data->dockId;
+     SolverRequest *request = &data->scratch->request;
+    SolverResponse *response = &data->scratch->response;
+    request->mtype = 1;
+    request->dockId = data->dockId;
 
-    if (msgsnd(mqid, &request, sizeof(request) - sizeof(long), 0) == -1) {
+    if (transport_send(solverQueue, request, sizeof(*request) - sizeof(long)) == -1) {
         perror("Error sending target dock to solver");
         return NULL;
     }
+    data->msgsSent++;
 
-    int i = data->startIndex;
+    long long i = data->startIndex;
+    int skipped = 0;
     while (i < data->endIndex) {
         pthread_mutex_lock(data->mutex);
         if (*(data->found)) {
@@ -522,91 +779,273 @@ char **gen_authString(int length, int *totalCount) {
         }
         pthread_mutex_unlock(data->mutex);
 
-        request.mtype = 2;
-        strcpy(request.authStringGuess, data->guesses[i]);
+        request->mtype = 2;
+        auth_plain_string(data->length, auth_order_at(data->order, i, &skipped), request->authStringGuess);
 
-        if (msgsnd(mqid, &request, sizeof(request) - sizeof(long), 0) == -1) {
+        if (transport_send(solverQueue, request, sizeof(*request) - sizeof(long)) == -1) {
             perror("Error sending auth string guess to solver");
-            i++;
+            i += data->stride;
             continue;
         }
-        SolverResponse response;
-        if(msgrcv(mqid, &response, sizeof(response) - sizeof(long), 3, 0) == -1){
+        data->guessesSent++;
+        data->msgsSent++;
+        if(transport_recv(solverQueue, response, sizeof(*response) - sizeof(long), 3) == -1){
             perror("Error receiving response from solver");
-            i++;
+            i += data->stride;
             continue;
         }
-        if(response.guessIsCorrect == 1){
+        data->msgsRecv++;
+        if(response->guessIsCorrect == 1){
             pthread_mutex_lock(data->mutex);
             if (!*(data->found)) {
                 *(data->found) = true;
-                data->correctGuess = strdup(data->guesses[i]);
+                data->correctGuess = arena_strdup(data->arena, request->authStringGuess);
             }
             pthread_mutex_unlock(data->mutex);
             break;
         }
-        else if(response.guessIsCorrect == -1){
+        else if(response->guessIsCorrect == -1){
             break;
         }
 
-        i++;
+        i += data->stride;
     }
 
     return NULL;
 }
 
+void *solver_pool_thread(void *arg) {
+    SolverPool *pool = (SolverPool *)arg;
+    pthread_mutex_lock(&pool->lock);
+    for (;;) {
+        while (!pool->head && !pool->stopping) {
+            pthread_cond_wait(&pool->ready, &pool->lock);
+        }
+        if (!pool->head) {
+            break;
+        }
+        Thr_data *task = pool->head;
+        pool->head = task->next;
+        if (!pool->head) {
+            pool->tail = NULL;
+        }
+        pthread_mutex_unlock(&pool->lock);
+
+        authStringThreadFunc(task);
+
+        // the task lives on the searching thread's stack; don't touch it
+        // once the last one is counted down
+        pthread_mutex_t *mutex = task->mutex;
+        pthread_cond_t *done = task->done;
+        pthread_mutex_lock(mutex);
+        if (--*task->running == 0) {
+            pthread_cond_signal(done);
+        }
+        pthread_mutex_unlock(mutex);
+
+        pthread_mutex_lock(&pool->lock);
+    }
+    pthread_mutex_unlock(&pool->lock);
+    return NULL;
+}
+
+void solver_pool_submit(SolverPool *pool, Thr_data *tasks, int count) {
+    pthread_mutex_lock(&pool->lock);
+    for (int i = 0; i < count; i++) {
+        tasks[i].next = NULL;
+        if (pool->tail) {
+            pool->tail->next = &tasks[i];
+        } else {
+            pool->head = &tasks[i];
+        }
+        pool->tail = &tasks[i];
+    }
+    pthread_cond_broadcast(&pool->ready);
+    pthread_mutex_unlock(&pool->lock);
+}
+
+// cpus, when set, gives each pool thread its cpu
+void solver_pool_start(SolverPool *pool, int numThreads, const int *cpus) {
+    for (int i = 0; i < numThreads; i++) {
+        pthread_attr_t attr;
+        pthread_attr_init(&attr);
+        if (cpus) {
+            pin_attr(&attr, cpus[i]);
+        }
+        if (pthread_create(&pool->threads[i], &attr, solver_pool_thread, pool) != 0) {
+            perror("error starting solver pool");
+            exit(EXIT_FAILURE);
+        }
+        pthread_attr_destroy(&attr);
+    }
+    pool->numThreads = numThreads;
+}
+
+void solver_pool_stop(SolverPool *pool) {
+    pthread_mutex_lock(&pool->lock);
+    pool->stopping = true;
+    pthread_cond_broadcast(&pool->ready);
+    pthread_mutex_unlock(&pool->lock);
+    for (int i = 0; i < pool->numThreads; i++) {
+        pthread_join(pool->threads[i], NULL);
+    }
+    pool->numThreads = 0;
+}
+
+// Offline ports have no solvers; every search succeeds within the timestep,
+// as a live one does, and only its cost is estimated. A shadow charges
+// what the live port's searches of that length have cost on average. The
+// evaluator (or a shadow before the live port has searched at that length)
+// puts the correct string at a pseudo-random index that only depends on the
+// dock, length and timestep, so policies that undock the same ship at the
+// same time pay the same, and charges what the plain split search sends
+// before some thread reaches it.
+bool simulate_authString(Port *port, int dockId, int freqLength) {
+    int bucket = freqLength < METRICS_AUTH_LEN_BUCKETS ? freqLength : METRICS_AUTH_LEN_BUCKETS - 1;
+    if (port->primary && port->liveLenCount[bucket] > 0) {
+        port->authGuesses += port->liveLenGuesses[bucket] / port->liveLenCount[bucket];
+    } else {
+        int length = freqLength < AUTH_MODEL_MAX_LEN ? freqLength : AUTH_MODEL_MAX_LEN;
+        long long total = auth_space_size(length);
+        uint64_t h = ((uint64_t)port->authSeed << 40) ^ ((uint64_t)dockId << 32) ^ ((uint64_t)length << 24)
+                     ^ (uint64_t)port->curr_timestep;
+        h ^= h >> 33;
+        h *= 0xff51afd7ed558ccdULL;
+        h ^= h >> 33;
+        h *= 0xc4ceb9fe1a85ec53ULL;
+        h ^= h >> 33;
+        long long hit = (long long)(h % (uint64_t)total);
+
+        long long share = total / port->m;
+        int owner = share == 0 ? port->m - 1 : (int)(hit / share < port->m - 1 ? hit / share : port->m - 1);
+        long long reached = hit - owner * share + 1;
+        for (int i = 0; i < port->m; i++) {
+            long long size = i == port->m - 1 ? total - i * share : share;
+            long long sent = size < reached ? size : reached;
+            port->authGuesses += sent;
+            port->solverGuesses[i] += sent;
+        }
+    }
+    port->authSearches++;
+    port->authLenCount[bucket]++;
+    return true;
+}
+
 // Improved auth string guessing using multithreading
-bool guess_authString(int dockId, int freqLength) {
+bool guess_authString(Port *port, int dockId, int freqLength) {
     if (freqLength <= 0) {
         return false;  // Invalid length
     }
+    if (port->offline) {
+        return simulate_authString(port, dockId, freqLength);
+    }
    
-    int totalStrings;
-    char **guesses = gen_authString(freqLength, &totalStrings);
+    long long searchStart = port->shadow ? now_ns() : 0;
+    // candidates are spelled out by the workers as they go, so the search
+    // needs no table whatever the length
+    AuthOrder order;
+    if (authModelPath) {
+        // most likely candidates first, the rest in plain order after them
+        pthread_rwlock_rdlock(&authModelLock);
+        auth_order_init(&order, &authModel, dockId, freqLength);
+        pthread_rwlock_unlock(&authModelLock);
+    } else {
+        auth_order_init(&order, NULL, dockId, freqLength);
+    }
+    long long totalStrings = order.total;
     bool found = false;
     char *correctGuess = NULL;
    
     //multiple threads to guess in parallel
-    pthread_t threads[m];
-    Thr_data threadData[m];
+    pthread_t threads[port->m];
+    Thr_data threadData[port->m];
     pthread_mutex_t mutex;
+    pthread_cond_t done;
+    int running = port->m;
     pthread_mutex_init(&mutex, NULL);
+    pthread_cond_init(&done, NULL);
    
     //divide work among threads
-    int thr_str_size = totalStrings / m;
-    for (int i=0; i<m; i++) {
-        threadData[i].startIndex = i * thr_str_size;
-        threadData[i].guesses = guesses;
-        threadData[i].solverMsgid = solver_ids[i];
-        threadData[i].endIndex = (i == m - 1) ? totalStrings : (i + 1) * thr_str_size;
+    //in learning mode interleave them so every solver starts on the likely guesses
+    long long thr_str_size = totalStrings / port->m;
+    for (int i=0; i<port->m; i++) {
+        if (authModelPath) {
+            threadData[i].startIndex = i;
+            threadData[i].endIndex = totalStrings;
+            threadData[i].stride = port->m;
+        } else {
+            threadData[i].startIndex = i * thr_str_size;
+            threadData[i].endIndex = (i == port->m - 1) ? totalStrings : (i + 1) * thr_str_size;
+            threadData[i].stride = 1;
+        }
+        threadData[i].guessesSent = 0;
+        threadData[i].msgsSent = 0;
+        threadData[i].msgsRecv = 0;
+        threadData[i].order = &order;
+        threadData[i].solverQueue = &port->solverQueues[i];
+        threadData[i].scratch = &port->solverScratch[i];
+        threadData[i].arena = &port->solverArenas[i];
         threadData[i].found = &found;
         threadData[i].mutex = &mutex;
         threadData[i].correctGuess = NULL;
         threadData[i].length = freqLength;
         threadData[i].dockId = dockId;
+        threadData[i].running = &running;
+        threadData[i].done = &done;
        
-        pthread_create(&threads[i],NULL,authStringThreadFunc,&threadData[i]);
+        if (solverPool.numThreads == 0) {
+            pthread_create(&threads[i],pinning ? &solverAttr[i] : NULL,authStringThreadFunc,&threadData[i]);
+        }
     }
    
     //wait for all threads to complete
-    for (int i = 0; i < m; i++) {
-        pthread_join(threads[i], NULL);
+    if (solverPool.numThreads > 0) {
+        solver_pool_submit(&solverPool, threadData, port->m);
+        pthread_mutex_lock(&mutex);
+        while (running > 0) {
+            pthread_cond_wait(&done, &mutex);
+        }
+        pthread_mutex_unlock(&mutex);
+    } else {
+        for (int i = 0; i < port->m; i++) {
+            pthread_join(threads[i], NULL);
+        }
+    }
+    long long searchGuesses = 0;
+    for (int i = 0; i < port->m; i++) {
+        searchGuesses += threadData[i].guessesSent;
+        port->authGuesses += threadData[i].guessesSent;
+        port->solverGuesses[i] += threadData[i].guessesSent;
+        port->solverSent[i] += threadData[i].msgsSent;
+        port->solverRecv[i] += threadData[i].msgsRecv;
         if (threadData[i].correctGuess) {
             correctGuess = threadData[i].correctGuess;
         }
     }
    
     //clean up
-    for (int i = 0; i < totalStrings; i++) {
-        free(guesses[i]);
-    }
-    free(guesses);
     pthread_mutex_destroy(&mutex);
+    pthread_cond_destroy(&done);
+   
+    port->authSearches++;
+    int bucket = freqLength < METRICS_AUTH_LEN_BUCKETS ? freqLength : METRICS_AUTH_LEN_BUCKETS - 1;
+    port->authLenCount[bucket]++;
+    port->authLenGuesses[bucket] += searchGuesses;
+    if (port->shadow) {
+        port->authNs += now_ns() - searchStart;
+    }
    
     //if found, copy the correct guess to shared memory
     if (correctGuess) {
-        strcpy(sharedMemory->authStrings[dockId], correctGuess);
-        free(correctGuess);
+        if (authModelPath) {
+            pthread_rwlock_wrlock(&authModelLock);
+            auth_model_record(&authModel, dockId, correctGuess);
+            if (auth_model_append(authModelLog, dockId, correctGuess) == -1) {
+                perror("error saving auth model history");
+            }
+            pthread_rwlock_unlock(&authModelLock);
+        }
+        strcpy(port->sharedMemory->authStrings[dockId], correctGuess);
         return true;
     }
    
@@ -616,50 +1055,52 @@ bool guess_authString(int dockId, int freqLength) {
 
 
 // Count available docks and emergency ships
-void cnt_available_docks(int *num_free_docks, int *emergencyShipCount) {
+void cnt_available_docks(Port *port, int *num_free_docks, int *emergencyShipCount) {
     *num_free_docks = 0;
     *emergencyShipCount = 0;
    
-    for (int i = 0; i < n; i++) {
-        if (!docks[i].isOccupied) {
+    for (int i = 0; i < port->n; i++) {
+        if (!port->docks[i].isOccupied) {
             (*num_free_docks)++;
         }
     }
    
-    for (int i = 0; i < nships; i++) {
-        if (ships[i].status == 0 && ships[i].emergency == 1) {
+    for (int i = 0; i < port->numOrdered; i++) {
+        if (port->shipOrder[i]->status == 0 && port->shipOrder[i]->emergency == 1) {
             (*emergencyShipCount)++;
         }
     }
 }
 
 //process emergency ships
-void process_emg_ships() {
+void process_emg_ships(Port *port) {
     int emergencyShipsAssigned = 0;
    
-    for (int i = 0; i < nships; i++) {
-        if (ships[i].status == 0 && ships[i].emergency == 1) {
-            int dockId = calc_optDock(&ships[i]);
+    for (int i = 0; i < port->numOrdered; i++) {
+        Ship *ship = port->shipOrder[i];
+        if (ship->status == 0 && ship->emergency == 1) {
+            int dockId = calc_optDock(port, ship);
            
             if (dockId != -1) {
-                ships[i].dockId = dockId; //dock the emergency ship
-                ships[i].status = 1;  //ship docked
+                ship->dockId = dockId; //dock the emergency ship
+                ship->status = 1;  //ship docked
                
-                docks[dockId].isOccupied = true;
-                docks[dockId].occupiedByShipId = ships[i].id;
-                docks[dockId].occupiedByDirection = ships[i].direction;
-                docks[dockId].dockingTimestep = curr_timestep;
-                docks[dockId].cargoFullyMoved = false;
+                port->docks[dockId].isOccupied = true;
+                port->docks[dockId].occupiedByShipId = ship->id;
+                port->docks[dockId].occupiedByDirection = ship->direction;
+                port->docks[dockId].dockingTimestep = port->curr_timestep;
+                port->docks[dockId].cargoFullyMoved = false;
                
                 // Clear crane usage
-                for (int j = 0; j < docks[dockId].numCranes; j++) {
-                    docks[dockId].craneUsed[j] = false;
-                }
+                crane_set_reset(&port->docks[dockId].cranes, port->docks[dockId].numCranes);
                
                 // Send docking message to validation
-                msg_to_val(2, ships[i].id, ships[i].direction, dockId, 0, 0);
+                msg_to_val(port, 2, ship->id, ship->direction, dockId, 0, 0);
                
                 emergencyShipsAssigned++;
+                int wait = port->curr_timestep - ship->firstArrival;
+                port->emgWait[wait < EMG_WAIT_BUCKETS ? wait : EMG_WAIT_BUCKETS - 1]++;
+                port->emgDocked++;
             }
         }
     }
@@ -673,76 +1114,106 @@ void freq(char *gs) {
     }
 }
 
+// sort a handful of ships back into shipOrder order
+void sort_by_rank(Ship **batch, int k) {
+    for (int i = 1; i < k; i++) {
+        Ship *ship = batch[i];
+        int j = i - 1;
+        while (j >= 0 && batch[j]->rank > ship->rank) {
+            batch[j + 1] = batch[j];
+            j--;
+        }
+        batch[j + 1] = ship;
+    }
+}
+
+void dock_reg_ship(Port *port, Ship *ship) {
+    // Try to dock the ship
+    int dockId = calc_optDock(port, ship);
+    if (dockId != -1) {
+        // Dock the ship
+        wheel_remove(port, ship);
+        ship->dockId = dockId;
+        ship->status = 1;  // Ship is now docked
+
+        port->docks[dockId].isOccupied = true;
+        port->docks[dockId].occupiedByDirection = ship->direction;
+        port->docks[dockId].occupiedByShipId = ship->id;
+        port->docks[dockId].cargoFullyMoved = false;
+        port->docks[dockId].dockingTimestep = port->curr_timestep;
+
+        // Clear crane usage
+        crane_set_reset(&port->docks[dockId].cranes, port->docks[dockId].numCranes);
+
+        // Send docking message to validation
+        msg_to_val(port, 2, ship->id, ship->direction, dockId, 0, 0);
+    }
+}
+
 // Process regular incoming ships
-void process_reg_ships() {
-    int i = 0;
-    if (nships > 0) {
-        do {
-            Ship *ship = &ships[i];
-    
-            // Skip ships that are not regular incoming waiting ships
-            if (ship->status != 0 || ship->direction != 1 || ship->emergency != 0) {
-                i++;
-                continue;
-            }
-    
-            // Check if the ship is still within its waiting time
-            if (!check_time(ship, curr_timestep)) {
-                i++;
-                continue;  // Ship will leave and return later
-            }
-    
-            // Try to dock the ship
-            int dockId = calc_optDock(ship);
-            if (dockId != -1) {
-                // Dock the ship
-                ship->dockId = dockId;
-                ship->status = 1;  // Ship is now docked
-    
-                docks[dockId].isOccupied = true;
-                docks[dockId].occupiedByDirection = ship->direction;
-                docks[dockId].occupiedByShipId = ship->id;
-                docks[dockId].cargoFullyMoved = false;
-                docks[dockId].dockingTimestep = curr_timestep;
-    
-                // Clear crane usage
-                for (int j = 0; j < docks[dockId].numCranes; j++) {
-                    docks[dockId].craneUsed[j] = false;
-                }
-    
-                // Send docking message to validation
-                msg_to_val(2, ship->id, ship->direction, dockId, 0, 0);
+// Only ships still within their waiting time are in the wheel; walking it by
+// deadline and each bucket by rank visits them in the same order as the
+// sorted ship table. Policies that order them some other way get the
+// ship table walk.
+void process_reg_ships(Port *port) {
+    if (!port->policy->deadlineFirst) {
+        for (int i = 0; i < port->numOrdered; i++) {
+            Ship *ship = port->shipOrder[i];
+            if (ship->status == 0 && ship->direction == 1 && ship->emergency == 0 && ship->wheelSlot != WHEEL_NONE) {
+                dock_reg_ship(port, ship);
             }
-    
-            i++;
-        } while (i < nships);
+        }
+        return;
+    }
+
+    Ship *batch[MAX_SHIP_REQUESTS];
+    int remaining = port->waitWheel.inSlots;
+
+    for (int d = 0; d < WAIT_WHEEL_SLOTS && remaining > 0; d++) {
+        int k = 0;
+        Ship *ship = port->waitWheel.slots[(port->waitWheel.now + d) & (WAIT_WHEEL_SLOTS - 1)];
+        for (; ship; ship = ship->wheelNext) {
+            batch[k++] = ship;
+        }
+        remaining -= k;
+        sort_by_rank(batch, k);
+        for (int i = 0; i < k; i++) {
+            dock_reg_ship(port, batch[i]);
+        }
+    }
+
+    int k = 0;
+    for (Ship *ship = port->waitWheel.overflow; ship; ship = ship->wheelNext) {
+        batch[k++] = ship;
     }
+    sort_by_rank(batch, k);
+    for (int i = 0; i < k; i++) {
+        dock_reg_ship(port, batch[i]);
     }
+}
 
- void process_out_ships() {
-    for (int i = 0; i < nships; i++) {
-        Ship *ship = &ships[i];
+ void process_out_ships(Port *port) {
+    for (int i = 0; i < port->numOrdered; i++) {
+        Ship *ship = port->shipOrder[i];
        
          if (ship->status != 0 || ship->direction != -1) {
             continue;
         }
        
-         int dockId = calc_optDock(ship);
+         int dockId = calc_optDock(port, ship);
         if (dockId != -1) {
              ship->dockId = dockId;
             ship->status = 1;   
            
-            docks[dockId].isOccupied = true;
-            docks[dockId].occupiedByShipId = ship->id;
-            docks[dockId].occupiedByDirection = ship->direction;
-            docks[dockId].dockingTimestep = curr_timestep;
-            docks[dockId].cargoFullyMoved = false;
+            port->docks[dockId].isOccupied = true;
+            port->docks[dockId].occupiedByShipId = ship->id;
+            port->docks[dockId].occupiedByDirection = ship->direction;
+            port->docks[dockId].dockingTimestep = port->curr_timestep;
+            port->docks[dockId].cargoFullyMoved = false;
            
-             for (int j = 0; j < docks[dockId].numCranes; j++) {
-                docks[dockId].craneUsed[j] = false;
-            }
+            crane_set_reset(&port->docks[dockId].cranes, port->docks[dockId].numCranes);
            
-             msg_to_val(2, ship->id, ship->direction, dockId, 0, 0);
+             msg_to_val(port, 2, ship->id, ship->direction, dockId, 0, 0);
         }
     }
 }
@@ -771,41 +1242,45 @@ void Sorting(int arr[], int n) {
 }
 
 
-void process_dock_helper(Dock *dock) {
+void process_dock_helper(Port *port, Dock *dock) {
      if (!dock->isOccupied) {
         return;
     }
 
     // Find the ship docked at this dock
-    Ship *ship = find_ship(dock->occupiedByShipId, dock->occupiedByDirection);
+    Ship *ship = find_ship(port, dock->occupiedByShipId, dock->occupiedByDirection);
     if (!ship) {
         fprintf(stderr, "error: Ship %d with direction %d not found\n",dock->occupiedByShipId, dock->occupiedByDirection);
         return;
     }
 
-     if (dock->dockingTimestep == curr_timestep) {
+     if (dock->dockingTimestep == port->curr_timestep) {
         return;
     }
 
      if (ship->direction == 1) {   
-        unload_cargo(ship, dock);
+        unload_cargo(port, ship, dock);
     } else {   
-        load_cargo(ship, dock);
+        load_cargo(port, ship, dock);
     }
 
      if (ship->cargoProcessed == ship->numCargo && !dock->cargoFullyMoved) {
         dock->cargoFullyMoved = true;
-        dock->lastCargoMovedTimestep = curr_timestep;
+        dock->lastCargoMovedTimestep = port->curr_timestep;
     }
 
-     if (dock->cargoFullyMoved && dock->lastCargoMovedTimestep != curr_timestep) {
+     if (dock->cargoFullyMoved && dock->lastCargoMovedTimestep != port->curr_timestep) {
         int freqLength = dock->lastCargoMovedTimestep - dock->dockingTimestep;
 
-        if (freqLength > 0 && guess_authString(dock->id, freqLength)) {
+        if (freqLength > 0 && guess_authString(port, dock->id, freqLength)) {
             // Undock the ship
-            msg_to_val(3, ship->id, ship->direction, dock->id, 0, 0);
+            msg_to_val(port, 3, ship->id, ship->direction, dock->id, 0, 0);
 
              ship->status = 2;  // Serviced
+            port->servicedSlots++;
+            port->shipsServed++;
+            port->regularServed += ship->emergency == 0;
+            port->turnaroundSum += port->curr_timestep - ship->firstArrival;
             dock->isOccupied = false;
             dock->cargoFullyMoved = false;
             dock->occupiedByShipId = -1;
@@ -814,120 +1289,1367 @@ void process_dock_helper(Dock *dock) {
     }
 }
 
-void process_Docks() {
-    for (int i = 0; i < n; i++) {
-        process_dock_helper(&docks[i]);
+void process_Docks(Port *port) {
+    for (int i = 0; i < port->n; i++) {
+        process_dock_helper(port, &port->docks[i]);
     }
 }
 
-int main(int argc, char *argv[]) {
-    if(argc != 2){
-        fprintf(stderr, "invalid usage , format is %s <testcase_number>\n", argv[0]);
-        exit(EXIT_FAILURE);
+// republish the telemetry page; runs once per timestep on the main thread
+void publish_metrics(Port *port, bool finished) {
+    if (!port->metrics) {
+        return;
+    }
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    metrics_write_begin(port->metrics);
+    port->metrics->finished = finished;
+    port->metrics->timestep = port->curr_timestep;
+    port->metrics->numDocks = port->n;
+    port->metrics->numSolvers = port->m;
+    port->metrics->publishedNs = (int64_t)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+    port->metrics->timesteps++;
+
+    port->metrics->totalShips = port->nships;
+    port->metrics->servicedShips = port->servicedSlots;
+    port->metrics->waitingEmergency = 0;
+    memset(port->metrics->waiting, 0, sizeof(port->metrics->waiting));
+    for (int i = 0; i < port->numOrdered; i++) {
+        Ship *ship = port->shipOrder[i];
+        if (ship->status == 0 && ship->category <= METRICS_MAX_CATEGORY) {
+            if (ship->emergency == 1) {
+                port->metrics->waitingEmergency++;
+            } else if (ship->direction == -1) {
+                port->metrics->waiting[ship->category][1]++;
+            } else if (ship->wheelSlot != WHEEL_NONE) {
+                port->metrics->waiting[ship->category][0]++;  // still within its waiting time
+            }
+        }
     }
 
-    int tc = atoi(argv[1]);
-    printf(" taken input is : %d,",tc);
-    srand(time(NULL));  
-   
+    for (int i = 0; i < port->n; i++) {
+        DockMetrics *dm = &port->metrics->docks[i];
+        int used = 0;
+        if (port->docks[i].isOccupied) {
+            for (int j = 0; j < port->docks[i].numCranes; j++) {
+                if (crane_set_is_used(&port->docks[i].cranes, j)) {
+                    used++;
+                }
+            }
+            dm->busySteps++;
+        }
+        dm->occupied = port->docks[i].isOccupied;
+        dm->shipId = port->docks[i].occupiedByShipId;
+        dm->direction = port->docks[i].occupiedByDirection;
+        dm->category = port->docks[i].category;
+        dm->numCranes = port->docks[i].numCranes;
+        dm->cranesUsed = used;
+        dm->craneMoves += used;
+    }
 
-    char inp_path[100];
-    sprintf(inp_path, "testcase%d/input.txt", tc);
-   
-    FILE *fp = fopen(inp_path, "r");
-    if(fp == NULL){
-        perror("error opening input file");
+    for (int i = 0; i < port->m; i++) {
+        port->metrics->solverGuesses[i] = port->solverGuesses[i];
+        port->metrics->solverSent[i] = port->solverSent[i];
+        port->metrics->solverRecv[i] = port->solverRecv[i];
+    }
+    port->metrics->authSearches = port->authSearches;
+    memcpy(port->metrics->authLenCount, port->authLenCount, sizeof(port->authLenCount));
+    port->metrics->mainSent = port->ipcMainSent;
+    port->metrics->mainRecv = port->ipcMainRecv;
+    metrics_write_end(port->metrics);
+}
+
+void open_metrics(Port *port, key_t key) {
+    port->metricsShmid = shmget(key, sizeof(PortMetrics), IPC_CREAT | 0644);
+    if (port->metricsShmid == -1) {
+        perror("error creating metrics shared memory");
         exit(EXIT_FAILURE);
     }
-   //taking inputs
-    key_t shm_key, main_q_key;
-    fscanf(fp, "%d", &shm_key);
-    fscanf(fp, "%d", &main_q_key);
+    port->metrics = (PortMetrics *)shmat(port->metricsShmid, NULL, 0);
+    if (port->metrics == (void *)-1) {
+        perror("error attaching metrics shared memory");
+        exit(EXIT_FAILURE);
+    }
+    memset(port->metrics, 0, sizeof(PortMetrics));
+}
+
+// readers keep their mapping after IPC_RMID and see finished == 1
+void close_metrics(Port *port) {
+    if (!port->metrics) {
+        return;
+    }
+    shmdt(port->metrics);
+    shmctl(port->metricsShmid, IPC_RMID, NULL);
+    port->metrics = NULL;
+}
+
+// --alloc-check: after warmup every timestep must run without the heap
+void check_allocs(Port *port) {
+    if (allocCheckWarmup <= 0) {
+        return;
+    }
+    port->stepsDone++;
+    if (port->stepsDone == allocCheckWarmup) {
+        // with several ports the guard arms once the last one is warm
+        if (atomic_fetch_add(&portsWarm, 1) + 1 == numPorts) {
+            alloc_guard_arm();
+        }
+        return;
+    }
+    long allocs = alloc_guard_count();
+    if (port->stepsDone > allocCheckWarmup && allocs > 0) {
+        fprintf(stderr, "alloc check failed: %ld heap allocations on the scheduling path by timestep %d"
+                " (step arena %zu bytes, high water %zu)\n",
+                allocs, port->curr_timestep, port->stepArena->capacity, port->stepArena->highWater);
+        exit(EXIT_FAILURE);
+    }
+}
+
+void destroy_arenas(Port *port) {
+    for (int i = 0; i < port->m; i++) {
+        arena_destroy(&port->solverArenas[i]);
+    }
+}
+
+void close_transports(Port *port) {
+    transport_close(&port->mainQueue, 0);
+    for (int i = 0; i < port->m; i++) {
+        transport_close(&port->solverQueues[i], 0);
+    }
+}
+
+// Ports are large (the ship table alone is about 1MB) and Dock needs 32-byte
+// alignment, so they come straight from mmap: zeroed and page aligned.
+Port *port_open(int tc) {
+    Port *port = mmap(NULL, sizeof(Port), PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (port == MAP_FAILED) {
+        perror("error allocating port");
+        exit(EXIT_FAILURE);
+    }
+    port->tc = tc;
+
+    char inp_path[100];
+    sprintf(inp_path, "testcase%d/input.txt", tc);
+   
+    FILE *fp = fopen(inp_path, "r");
+    if(fp == NULL){
+        perror("error opening input file");
+        exit(EXIT_FAILURE);
+    }
+   //taking inputs
+    key_t shm_key, main_q_key;
+    fscanf(fp, "%d", &shm_key);
+    fscanf(fp, "%d", &main_q_key);
    //debug :   printf(" inputs : shmkey and msg queue key : %d   %d \n",shm_key,main_q_key);
-     shmid = shmget(shm_key, sizeof(MainSharedMemory), 0666);
-    if (shmid == -1) {
+     port->shmid = shmget(shm_key, sizeof(MainSharedMemory), 0666);
+    if (port->shmid == -1) {
         perror("error connecting to shared memory");
         exit(EXIT_FAILURE);
     }
 
 
-    sharedMemory = (MainSharedMemory *)shmat(shmid, NULL, 0);
-    if (sharedMemory == (void *)-1) {
+    port->sharedMemory = (MainSharedMemory *)shmat(port->shmid, NULL, 0);
+    if (port->sharedMemory == (void *)-1) {
         perror("error attaching shared memory");
         exit(EXIT_FAILURE);
     }
    
-    mqid = msgget(main_q_key, 0666);
-    if (mqid == -1) {
+    if (transport_open(&port->mainQueue, ipcKind, main_q_key, IPC_SCHEDULER_SIDE, 0666) == -1) {
         perror("error connecting to message queue");
         exit(EXIT_FAILURE);
     }
    
-    fscanf(fp, "%d", &m);
-    for (int i = 0; i < m; i++) {
+    fscanf(fp, "%d", &port->m);
+    for (int i = 0; i < port->m; i++) {
         key_t solver_key;
         fscanf(fp, "%d", &solver_key);
 
-        solver_ids[i] = msgget(solver_key, 0666);
-        if (solver_ids[i] == -1) {
+        if (transport_open(&port->solverQueues[i], ipcKind, solver_key, IPC_SCHEDULER_SIDE, 0666) == -1) {
             perror("error connecting to solver message queue");
             exit(EXIT_FAILURE);
         }
+        arena_init(&port->solverArenas[i], SOLVER_ARENA_SIZE);
     }
    
-    fscanf(fp, "%d", &n);
-    for (int i = 0; i < n; i++) {
-        docks[i].id = i;
-        fscanf(fp, "%d", &docks[i].category);
-        docks[i].numCranes = docks[i].category;
+    fscanf(fp, "%d", &port->n);
+    for (int i = 0; i < port->n; i++) {
+        port->docks[i].id = i;
+        fscanf(fp, "%d", &port->docks[i].category);
+        port->docks[i].numCranes = port->docks[i].category;
        
-        for (int j = 0; j < docks[i].numCranes; j++) {
-            fscanf(fp, "%d", &docks[i].craneCapacities[j]);
+        for (int j = 0; j < port->docks[i].numCranes; j++) {
+            fscanf(fp, "%d", &port->docks[i].cranes.capacity[j]);
         }
+        crane_set_reset(&port->docks[i].cranes, port->docks[i].numCranes);
        
-        docks[i].isOccupied = false;
-        docks[i].cargoFullyMoved = false;
-        docks[i].occupiedByShipId = -1;
-        docks[i].occupiedByDirection = 0;
+        port->docks[i].isOccupied = false;
+        port->docks[i].cargoFullyMoved = false;
+        port->docks[i].occupiedByShipId = -1;
+        port->docks[i].occupiedByDirection = 0;
     }
    
     fclose(fp);
-    printf("taken input successfully! \n");
-    MessageStruct m;
+    port->policy = policies[0];
+    port->reserve = reserveCount;
+    port->reserveHorizon = reserveHorizon;
+    return port;
+}
+
+// A port with no IPC at all (evaluator, shadow): given docks, requests read
+// from memory.
+Port *port_open_offline(const Dock *docks, int n, int m, const SchedPolicy *policy, MainSharedMemory *memory) {
+    Port *port = mmap(NULL, sizeof(Port), PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (port == MAP_FAILED) {
+        perror("error allocating port");
+        exit(EXIT_FAILURE);
+    }
+    port->offline = true;
+    port->policy = policy;
+    port->sharedMemory = memory;
+    port->m = m;
+    port->n = n;
+    memcpy(port->docks, docks, n * sizeof(Dock));
+    return port;
+}
+
+// --shadow: a second port that follows the live one's requests with its
+// own policy; opened before the first timestep so both start empty. It
+// reads them from its own copy of the request buffer, filled from the
+// live port's queue on the shadow thread.
+void shadow_open(Port *port, const SchedPolicy *policy) {
+    MainSharedMemory *copy = mmap(NULL, sizeof(MainSharedMemory), PROT_READ | PROT_WRITE,
+                                  MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    port->shadowQueue = mmap(NULL, sizeof(ShadowQueue), PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (copy == MAP_FAILED || port->shadowQueue == MAP_FAILED) {
+        perror("error allocating shadow requests");
+        exit(EXIT_FAILURE);
+    }
+    port->shadow = port_open_offline(port->docks, port->n, port->m, policy, copy);
+    port->shadow->primary = port;
+    port->shadow->authSeed = port->tc;
+    port->shadow->reserve = shadowReserve;
+    port->shadow->reserveHorizon = shadowReserveHorizon;
+}
+
+void port_close(Port *port) {
+    if (port->shadow) {
+        port_close(port->shadow);
+        munmap(port->shadowQueue, sizeof(ShadowQueue));
+    }
+    if (port->offline) {
+        if (port->primary) {
+            munmap(port->sharedMemory, sizeof(MainSharedMemory));
+        }
+        munmap(port, sizeof(Port));
+        return;
+    }
+    destroy_arenas(port);
+    close_metrics(port);
+    //shared memory cleanup
+    close_transports(port);
+    if(shmdt(port->sharedMemory) == -1){
+        perror("error detaching shared memory\n");
+    }
+    munmap(port, sizeof(Port));
+}
+
+// Timestep at which ship, docked at dock, is expected to undock. Cargo
+// moves as process_dock_helper moves it: every timestep from the one after
+// docking, in order, one item per free crane until an item fits none of
+// the cranes left. The auth search and undock come a timestep after the
+// last item. INT_MAX if some item fits no crane at all: that dock is never
+// counted as freeing up.
+int predict_undock(Port *port, const Dock *dock, const Ship *ship) {
+    if (dock->cargoFullyMoved) {
+        return port->curr_timestep;
+    }
+    int t = dock->dockingTimestep == port->curr_timestep ? port->curr_timestep + 1 : port->curr_timestep;
+    int cargoIdx = ship->cargoProcessed;
+    if (cargoIdx == ship->numCargo) {
+        return t + 1;
+    }
+    CraneSet cranes = dock->cranes;
+    while (cargoIdx < ship->numCargo) {
+        crane_set_reset(&cranes, dock->numCranes);
+        int moved = 0;
+        int crane;
+        while (cargoIdx < ship->numCargo && (crane = port->policy->choose_crane(&cranes, ship->cargo[cargoIdx])) != -1) {
+            crane_set_use(&cranes, crane);
+            cargoIdx++;
+            moved++;
+        }
+        if (moved == 0) {
+            return INT_MAX;
+        }
+        t++;
+    }
+    return t;
+}
+
+// --reserve, once per timestep, after the emergency pass and before the
+// others. The <reserve> highest-category docks among those free or
+// expected to undock within the horizon are set aside for emergency ships,
+// as they fit the most of them; ones about to free up cost nothing to
+// keep, so they win ties. Emergencies waiting now have already had their
+// pick of the free docks, so what is held is for those expected within the
+// horizon at the recent arrival rate, plus waiting ones that only a dock
+// about to free up fits. A held free dock takes emergencies only. Other
+// set-aside free docks are spares, which other ships only get when no
+// unreserved free dock fits them.
+void reserve_docks(Port *port) {
+    port->emgRate += (port->emgArrivals - port->emgRate) / EMG_RATE_WINDOW;
+    port->emgArrivals = 0;
+
+    bool soon[MAX_DOCKS], picked[MAX_DOCKS];
+    int picks[MAX_DOCKS], numPicks = 0;
+    for (int i = 0; i < port->n; i++) {
+        Dock *dock = &port->docks[i];
+        Ship *ship = dock->isOccupied ? find_ship(port, dock->occupiedByShipId, dock->occupiedByDirection) : NULL;
+        dock->reserved = RESERVE_NONE;
+        soon[i] = ship && predict_undock(port, dock, ship) < port->curr_timestep + port->reserveHorizon;
+        picked[i] = false;
+    }
+    while (numPicks < port->reserve) {
+        int best = -1;
+        for (int i = 0; i < port->n; i++) {
+            if (picked[i] || (port->docks[i].isOccupied && !soon[i])) {
+                continue;
+            }
+            if (best == -1 || port->docks[i].category > port->docks[best].category
+                || (port->docks[i].category == port->docks[best].category && soon[i] && !soon[best])) {
+                best = i;
+            }
+        }
+        if (best == -1) {
+            break;
+        }
+        picked[best] = true;
+        picks[numPicks++] = best;
+    }
+
+    int waiting = 0;
+    for (int i = 0; i < port->numOrdered; i++) {
+        Ship *ship = port->shipOrder[i];
+        if (ship->status == 0 && ship->emergency == 1) {
+            for (int k = 0; k < numPicks; k++) {
+                if (port->docks[picks[k]].category >= ship->category) {
+                    waiting++;
+                    break;
+                }
+            }
+        }
+    }
+    double expected = waiting + port->emgRate * port->reserveHorizon;
+    int hold = expected + 0.5 < numPicks ? (int)(expected + 0.5) : numPicks;
+    port->spareDocks = 0;
+    bool held = false;
+    for (int k = 0; k < numPicks; k++) {
+        Dock *dock = &port->docks[picks[k]];
+        if (soon[picks[k]]) {
+            continue;
+        }
+        if (k < hold) {
+            dock->reserved = RESERVE_HELD;
+            held = true;
+        } else {
+            dock->reserved = RESERVE_SPARE;
+            port->spareDocks++;
+        }
+    }
+    port->heldSteps += held;
+}
 
-    bool all_ships_done = false;
+// timesteps within which a fraction q of the docked emergency ships got a dock
+int wait_percentile(const int *emgWait, long long docked, double q) {
+    long long need = (long long)(q * docked + 0.999999), seen = 0;
+    for (int w = 0; w < EMG_WAIT_BUCKETS; w++) {
+        seen += emgWait[w];
+        if (seen >= need && seen > 0) {
+            return w;
+        }
+    }
+    return 0;
+}
+
+int emg_wait_percentile(const Port *port, double q) {
+    return wait_percentile(port->emgWait, port->emgDocked, q);
+}
+
+void port_totals(const Port *port, PortTotals *t) {
+    t->shipsServed = port->shipsServed;
+    t->deadlineMisses = port->deadlineMisses;
+    t->turnaroundSum = port->turnaroundSum;
+    t->authGuesses = port->authGuesses;
+    t->authNs = port->authNs;
+    t->emgDocked = port->emgDocked;
+    memcpy(t->emgWait, port->emgWait, sizeof(t->emgWait));
+}
+
+// dock and move cargo for the requests already taken in
+void schedule_step(Port *port) {
+    port->numDockings = 0;
+    prune_ship_order(port);
+    sort_ships(port);
+    for (int i = 0; i < port->numOrdered; i++) {
+        port->shipOrder[i]->rank = i;
+    }
+    int num_free_docks, emergencyShipCount;
+    cnt_available_docks(port, &num_free_docks, &emergencyShipCount);
+    bool reserved = port->reserve == 0;
    
-    printf("scheduling starting... \n");
-     while (!all_ships_done) {
-         if (msgrcv(mqid, &m, sizeof(MessageStruct) - sizeof(long), 1, 0) == -1) {
-            perror("Error in receiving messages from validation!!! ");
+    for (int pass = 0; pass < NUM_PASSES; pass++) {
+        if (!reserved && port->policy->passes[pass] != PASS_EMERGENCY) {
+            reserve_docks(port);
+            reserved = true;
+        }
+        switch (port->policy->passes[pass]) {
+        case PASS_EMERGENCY:
+            process_emg_ships(port);
+            break;
+        case PASS_REGULAR:
+            process_reg_ships(port);
+            break;
+        case PASS_OUTGOING:
+            process_out_ships(port);
+            break;
+        }
+    }
+    process_Docks(port);
+}
+
+// match this timestep's dockings of the live port and its shadow
+void shadow_compare(Port *port, const ShadowStep *step) {
+    Port *shadow = port->shadow;
+    ShadowStats *st = &port->shadowStats;
+    int matched = 0;
+    for (int i = 0; i < step->numDockings; i++) {
+        for (int j = 0; j < shadow->numDockings; j++) {
+            if (memcmp(&step->dockings[i], &shadow->dockings[j], sizeof(Docking)) == 0) {
+                matched++;
+                break;
+            }
+        }
+    }
+    st->steps++;
+    st->primaryDockings += step->numDockings;
+    st->shadowDockings += shadow->numDockings;
+    int diff = step->numDockings + shadow->numDockings - 2 * matched;
+    if (diff == 0) {
+        return;
+    }
+    if (st->diffSteps++ == 0) {
+        st->firstDiff = step->timestep;
+    }
+    st->diffDecisions += diff;
+    if (shadowDiffFile) {
+        // ship/direction->dock, live port first; built whole so one write
+        // puts it in the file and lines of different ports never mix
+        char line[4096];
+        int len = snprintf(line, sizeof(line), "tc %d t %d live", port->tc, step->timestep);
+        for (int i = 0; i < step->numDockings; i++) {
+            len += snprintf(line + len, sizeof(line) - len, " %d/%d->%d", step->dockings[i].shipId,
+                            step->dockings[i].direction, step->dockings[i].dockId);
+        }
+        len += snprintf(line + len, sizeof(line) - len, " | shadow");
+        for (int j = 0; j < shadow->numDockings; j++) {
+            len += snprintf(line + len, sizeof(line) - len, " %d/%d->%d", shadow->dockings[j].shipId,
+                            shadow->dockings[j].direction, shadow->dockings[j].dockId);
+        }
+        len += snprintf(line + len, sizeof(line) - len, "\n");
+        fwrite(line, 1, len, shadowDiffFile);
+    }
+}
+
+// Live side of --shadow: the slot the next timestep goes into, or NULL
+// once the shadow has fallen SHADOW_QUEUE_STEPS behind. Taken before the
+// timestep runs, so the live totals kept on stopping end where the
+// shadow's do. The live port
+// never waits for its shadow; a shadow that can't keep up is stopped for
+// good, since skipping timesteps would leave it in some other state.
+ShadowStep *shadow_slot(Port *port) {
+    ShadowQueue *q = port->shadowQueue;
+    if (port->shadowStats.stoppedAt) {
+        return NULL;
+    }
+    unsigned tail = atomic_load_explicit(&q->tail, memory_order_relaxed);
+    if (tail - atomic_load_explicit(&q->head, memory_order_acquire) == SHADOW_QUEUE_STEPS) {
+        port->shadowStats.stoppedAt = port->curr_timestep;
+        port_totals(port, &port->shadowStats.liveAtStop);
+        return NULL;
+    }
+    return &q->steps[tail % SHADOW_QUEUE_STEPS];
+}
+
+void shadow_push(Port *port) {
+    atomic_fetch_add_explicit(&port->shadowQueue->tail, 1, memory_order_release);
+    sem_post(&shadowWake);
+}
+
+// one live timestep, replayed on the shadow thread
+void shadow_run_step(Port *port, const ShadowStep *step) {
+    Port *shadow = port->shadow;
+    shadow->curr_timestep = step->timestep;
+    if (step->finished) {
+        shadow->finished = true;
+        return;
+    }
+    long long start = now_ns();
+    memcpy(shadow->liveLenCount, step->authLenCount, sizeof(step->authLenCount));
+    memcpy(shadow->liveLenGuesses, step->authLenGuesses, sizeof(step->authLenGuesses));
+    memcpy(shadow->sharedMemory->newShipRequests, step->requests, step->numRequests * sizeof(ShipRequest));
+    shadow->timesteps++;
+    wheel_advance(shadow, shadow->curr_timestep);
+    new_ship_req(shadow, step->numRequests);
+    schedule_step(shadow);
+    timestep_inc(shadow);
+    shadow_compare(port, step);
+    port->shadowStats.shadowNs += now_ns() - start;
+}
+
+// Every port's shadow runs here, off the threads that run live ports, so
+// a shadow timestep never delays the next live receive. As a batch thread
+// its wakeups don't preempt the live thread that posted them; it runs when
+// that thread blocks or on another cpu.
+void *shadow_thread(void *arg) {
+    (void)arg;
+    struct sched_param param = { .sched_priority = 0 };
+    pthread_setschedparam(pthread_self(), SCHED_BATCH, &param);
+    // the step arena is only live within a shadow timestep
+    Arena stepArena;
+    arena_init(&stepArena, SOLVER_ARENA_SIZE);  // offline timesteps don't allocate
+    for (;;) {
+        sem_wait(&shadowWake);
+        bool stopping = atomic_load(&shadowStopping);
+        for (int i = 0; i < numPorts; i++) {
+            Port *port = ports[i];
+            ShadowQueue *q = port->shadowQueue;
+            unsigned head = atomic_load_explicit(&q->head, memory_order_relaxed);
+            while (head != atomic_load_explicit(&q->tail, memory_order_acquire)) {
+                port->shadow->stepArena = &stepArena;
+                shadow_run_step(port, &q->steps[head % SHADOW_QUEUE_STEPS]);
+                atomic_store_explicit(&q->head, ++head, memory_order_release);
+            }
+        }
+        if (stopping) {
+            break;
+        }
+    }
+    arena_destroy(&stepArena);
+    struct timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    shadowCpuNs = ts.tv_sec * 1000000000LL + ts.tv_nsec;
+    return NULL;
+}
+
+void shadow_start() {
+    sem_init(&shadowWake, 0, 0);
+    if (pthread_create(&shadowThread, NULL, shadow_thread, NULL) != 0) {
+        perror("error starting shadow thread");
+        exit(EXIT_FAILURE);
+    }
+}
+
+// once every live port is done: the shadows finish what is queued
+void shadow_stop() {
+    atomic_store(&shadowStopping, true);
+    sem_post(&shadowWake);
+    pthread_join(shadowThread, NULL);
+    sem_destroy(&shadowWake);
+}
+
+// handle one message from validation; returns true once it reports the end
+bool run_timestep(Port *port, const MessageStruct *m) {
+    port->curr_timestep=m->timestep;
+   //printf("debuging : current timestep %d ",port->curr_timestep);
+    if(m->isFinished==1){
+        port->finished = true;
+        if (port->shadow) {
+            ShadowStep *step = shadow_slot(port);
+            if (step) {
+                step->timestep = m->timestep;
+                step->finished = true;
+                shadow_push(port);
+            }
+        }
+        publish_metrics(port, true);
+        if (allocCheckWarmup > 0 && port->stepsDone < allocCheckWarmup) {
+            atomic_fetch_add(&portsWarm, 1);  // never got warm, don't hold up the others
+        }
+        return true;
+    }
+    // here we are handling ship requests
+    //printf("Handling ship requests! ");
+    //printf("debug:Calling new_ship_req function!")
+    long long start = port->shadow ? now_ns() : 0;
+    ShadowStep *step = port->shadow ? shadow_slot(port) : NULL;
+    port->timesteps++;
+    wheel_advance(port, port->curr_timestep);
+    new_ship_req(port, m->numShipRequests);
+    schedule_step(port);
+    publish_metrics(port, false);
+    if (step) {
+        // validation may refill the request buffer once the timestep is
+        // acknowledged, so the shadow's copy is taken now; the shadow
+        // thread does the rest
+        long long intake = now_ns();
+        step->timestep = m->timestep;
+        step->finished = false;
+        step->numDockings = port->numDockings;
+        memcpy(step->dockings, port->dockings, port->numDockings * sizeof(Docking));
+        memcpy(step->authLenCount, port->authLenCount, sizeof(port->authLenCount));
+        memcpy(step->authLenGuesses, port->authLenGuesses, sizeof(port->authLenGuesses));
+        step->numRequests = m->numShipRequests;
+        memcpy(step->requests, port->sharedMemory->newShipRequests, m->numShipRequests * sizeof(ShipRequest));
+        shadow_push(port);
+        port->shadowStats.pathNs += now_ns() - intake;
+    }
+    timestep_inc(port);
+    if (step) {
+        port->shadowStats.primaryNs += now_ns() - start;
+    }
+    check_allocs(port);
+    return false;
+}
+
+// Multi-port mode: every worker sweeps all ports, claims the idle ones and
+// runs whatever timestep validation has queued for them. A port is only
+// ever run by one worker at a time, so its state needs no locking; workers
+// back off while nothing is ready.
+void *port_worker(void *arg) {
+    int first = (int)(intptr_t)arg;  // spread the sweeps over different ports
+    int backoff = PORT_POLL_MIN_US;
+    MessageStruct m;
+    // the step arena is only live within a timestep, so one per worker is
+    // enough however many ports it runs
+    Arena stepArena;
+    arena_init(&stepArena, STEP_ARENA_SIZE);
+
+    while (atomic_load(&portsLeft) > 0) {
+        bool progressed = false;
+        for (int k = 0; k < numPorts; k++) {
+            Port *port = ports[(first + k) % numPorts];
+            int idle = 0;
+            if (!atomic_compare_exchange_strong(&port->claimed, &idle, 1)) {
+                continue;
+            }
+            if (!port->finished) {
+                if (transport_try_recv(&port->mainQueue, &m, sizeof(MessageStruct) - sizeof(long), 1) != -1) {
+                    port->ipcMainRecv++;
+                    port->stepArena = &stepArena;
+                    progressed = true;
+                    if (run_timestep(port, &m)) {
+                        printf("testcase %d: done with all ships\n", port->tc);
+                        atomic_fetch_sub(&portsLeft, 1);
+                    }
+                    // a rare long auth search must not pin its table in
+                    // every worker for the rest of the run
+                    arena_trim(&stepArena, STEP_ARENA_SIZE);
+                } else if (errno != ENOMSG) {
+                    perror("Error in receiving messages from validation!!! ");
+                    exit(EXIT_FAILURE);
+                }
+            }
+            atomic_store(&port->claimed, 0);
+        }
+        if (progressed) {
+            backoff = PORT_POLL_MIN_US;
+        } else {
+            usleep(backoff);
+            backoff = backoff * 2 < PORT_POLL_MAX_US ? backoff * 2 : PORT_POLL_MAX_US;
+        }
+    }
+    arena_destroy(&stepArena);
+    return NULL;
+}
+
+// "N" or "A-B"; returns the number of testcases added, -1 if malformed,
+// -2 if they would take the process past MAX_PORTS
+int parse_testcases(const char *arg, int *tcs, int count) {
+    char *end;
+    long first = strtol(arg, &end, 10);
+    long last = first;
+    if (*end == '-') {
+        last = strtol(end + 1, &end, 10);
+    }
+    if (*end != '\0' || end == arg || last < first) {
+        return -1;
+    }
+    if (last - first + 1 > MAX_PORTS - count) {
+        return -2;
+    }
+    int added = 0;
+    for (long tc = first; tc <= last; tc++) {
+        tcs[count + added++] = tc;
+    }
+    return added;
+}
+
+void report_host_usage(int solverThreads) {
+    struct rusage ru;
+    getrusage(RUSAGE_SELF, &ru);
+    printf("host: %d ports, %d port workers, %d solver threads | cpu user %.2fs sys %.2fs | max rss %ld KB\n",
+           numPorts, portWorkers, solverThreads,
+           ru.ru_utime.tv_sec + ru.ru_utime.tv_usec / 1e6,
+           ru.ru_stime.tv_sec + ru.ru_stime.tv_usec / 1e6, ru.ru_maxrss);
+}
+
+// --pin: "auto" plans cpus from the sysfs topology, anything else is a cpu
+// list ("2,4-7") taken in order. The scheduling threads (the main loop, or
+// the port workers) get the first cpus, solver workers the ones after.
+void setup_pinning(const char *spec, int schedThreads, int solverThreads) {
+    int count = schedThreads + solverThreads;
+    if (topology_load(&topology) == -1) {
+        fprintf(stderr, "could not read cpu topology, not pinning\n");
+        return;
+    }
+    if (strcmp(spec, "auto") == 0) {
+        topology_plan(&topology, pinPlan, count);
+    } else {
+        int list[2 * MAX_POOL_THREADS];
+        int len = parse_cpu_list(spec, list, 2 * MAX_POOL_THREADS);
+        if (len <= 0) {
+            fprintf(stderr, "bad cpu list %s\n", spec);
             exit(EXIT_FAILURE);
         }
-       
-         curr_timestep=m.timestep;
-       //printf("debuging : current timestep %d ",curr_timestep);
-        if(m.isFinished==1){
-            all_ships_done = true;
-            printf("done with all ships ...  exiting\n ");
+        for (int i = 0; i < count; i++) {
+            pinPlan[i] = list[i % len];
+        }
+    }
+    pinning = true;
+
+    printf("pinning (%d cpus, %d nodes): scheduling", topology.numCpus, topology.numNodes);
+    for (int i = 0; i < count; i++) {
+        printf("%s%d", i == schedThreads ? " | solvers " : " ", pinPlan[i]);
+    }
+    printf("\n");
+}
+
+// Single-port mode: the main loop runs on the first planned cpu and solver
+// queue i's worker on the cpu after, with its message buffers on that
+// cpu's node. In multi-port mode any pool thread serves any queue, so the
+// buffers are left to first touch; auto keeps the pool on one node when
+// it fits.
+void pin_port(Port *port) {
+    int err = pin_thread(pthread_self(), pinPlan[0]);
+    if (err) {
+        fprintf(stderr, "error pinning main loop to cpu %d: %s\n", pinPlan[0], strerror(err));
+    }
+    for (int i = 0; i < port->m; i++) {
+        pthread_attr_init(&solverAttr[i]);
+        pin_attr(&solverAttr[i], pinPlan[1 + i]);
+        bind_to_node(&topology, &port->solverScratch[i], sizeof(SolverScratch),
+                     topology_node_of(&topology, pinPlan[1 + i]));
+    }
+}
+
+// --record: the port's docks and every ship request validation sends, in
+// the format --evaluate reads
+void record_docks(FILE *fp, Port *port) {
+    fprintf(fp, "docks %d %d\n", port->n, port->m);
+    for (int i = 0; i < port->n; i++) {
+        fprintf(fp, "dock %d", port->docks[i].category);
+        for (int j = 0; j < port->docks[i].numCranes; j++) {
+            fprintf(fp, " %d", port->docks[i].cranes.capacity[j]);
+        }
+        fprintf(fp, "\n");
+    }
+}
+
+void record_step(FILE *fp, Port *port, const MessageStruct *m) {
+    if (m->isFinished == 1) {
+        fprintf(fp, "end %d\n", m->timestep);
+        return;
+    }
+    for (int i = 0; i < m->numShipRequests; i++) {
+        ShipRequest *req = &port->sharedMemory->newShipRequests[i];
+        fprintf(fp, "ship %d %d %d %d %d %d %d", req->timestep, req->shipId, req->category, req->direction,
+                req->emergency, req->waitingTime, req->numCargo);
+        for (int j = 0; j < req->numCargo; j++) {
+            fprintf(fp, " %d", req->cargo[j]);
+        }
+        fprintf(fp, "\n");
+    }
+}
+
+void workload_add_dock(Workload *w, int category) {
+    Dock *dock = &w->docks[w->n];
+    dock->id = w->n++;
+    dock->category = category;
+    dock->numCranes = category;
+    dock->occupiedByShipId = -1;
+    crane_set_reset(&dock->cranes, category);
+}
+
+// a file written by --record; returns -1 if it can't be read
+int workload_load(Workload *w, const char *path) {
+    FILE *fp = fopen(path, "r");
+    if (fp == NULL) {
+        return -1;
+    }
+    char word[16];
+    int docks = 0, cap = 0, ok = 1;
+    while (ok && fscanf(fp, "%15s", word) == 1) {
+        if (strcmp(word, "docks") == 0) {
+            ok = fscanf(fp, "%d %d", &docks, &w->m) == 2 && docks > 0 && docks <= MAX_DOCKS
+                 && w->m > 0 && w->m <= MAX_SOLVERS;
+        } else if (strcmp(word, "dock") == 0) {
+            int category;
+            ok = w->n < docks && fscanf(fp, "%d", &category) == 1 && category > 0 && category <= MAX_CATEGORY;
+            for (int j = 0; ok && j < category; j++) {
+                ok = fscanf(fp, "%d", &w->docks[w->n].cranes.capacity[j]) == 1;
+            }
+            if (ok) {
+                workload_add_dock(w, category);
+            }
+        } else if (strcmp(word, "ship") == 0) {
+            if (w->numRequests == cap) {
+                cap = cap ? 2 * cap : 1024;
+                w->requests = realloc(w->requests, cap * sizeof(ShipRequest));
+                if (!w->requests) {
+                    perror("Memory allocation failed");
+                    exit(EXIT_FAILURE);
+                }
+            }
+            ShipRequest *req = &w->requests[w->numRequests];
+            ok = fscanf(fp, "%d %d %d %d %d %d %d", &req->timestep, &req->shipId, &req->category, &req->direction,
+                        &req->emergency, &req->waitingTime, &req->numCargo) == 7
+                 && req->numCargo >= 0 && req->numCargo <= MAX_CARGO_COUNT;
+            for (int j = 0; ok && j < req->numCargo; j++) {
+                ok = fscanf(fp, "%d", &req->cargo[j]) == 1;
+            }
+            w->numRequests += ok;
+        } else if (strcmp(word, "end") == 0) {
+            ok = fscanf(fp, "%d", &w->endTimestep) == 1;
+        } else {
+            ok = 0;
+        }
+    }
+    fclose(fp);
+    if (!ok || w->n == 0 || w->n != docks || w->endTimestep <= 0) {
+        return -1;
+    }
+    return 0;
+}
+
+// "gen:<seed>[,steps[,load]]": docks and ships shaped like the test
+// validator's, up to three new ships a timestep. Cargo is never heavier
+// than the strongest crane of any dock the ship fits, so no dock is held
+// forever by an item nothing there can lift.
+void workload_generate(Workload *w, unsigned seed, int steps, int load) {
+    unsigned rng = seed;
+    w->generated = true;
+    w->seed = seed;
+    w->load = load;
+    w->m = GEN_SOLVERS;
+    w->endTimestep = steps + 1;
+    int docks = 4 + rand_r(&rng) % 5;
+    for (int i = 0; i < docks; i++) {
+        int category = 1 + rand_r(&rng) % 6;
+        w->maxCategory = category > w->maxCategory ? category : w->maxCategory;
+        for (int j = 0; j < category; j++) {
+            w->docks[w->n].cranes.capacity[j] = 5 + rand_r(&rng) % 40;
+        }
+        workload_add_dock(w, category);
+    }
+    for (int c = 1; c <= w->maxCategory; c++) {
+        w->liftLimit[c] = INT_MAX;
+        for (int i = 0; i < w->n; i++) {
+            if (w->docks[i].category < c) {
+                continue;
+            }
+            int strongest = 0;
+            for (int j = 0; j < w->docks[i].numCranes; j++) {
+                int cap = w->docks[i].cranes.capacity[j];
+                strongest = cap > strongest ? cap : strongest;
+            }
+            w->liftLimit[c] = strongest < w->liftLimit[c] ? strongest : w->liftLimit[c];
+        }
+    }
+}
+
+// Fill the port's request buffer for timestep t, as validation would;
+// returns the number of requests.
+int workload_step(Workload *w, Port *port, int t) {
+    ShipRequest *out = port->sharedMemory->newShipRequests;
+    int k = 0;
+    if (!w->generated) {
+        for (; w->next < w->numRequests && w->requests[w->next].timestep <= t; w->next++) {
+            if (k < MAX_NEW_REQUESTS) {
+                out[k++] = w->requests[w->next];
+            }
+        }
+        return k;
+    }
+
+    for (int i = 0; i < 3; i++) {
+        if ((int)(rand_r(&w->rng) % 300) >= w->load) {
+            continue;
+        }
+        ShipRequest *req = &out[k++];
+        req->shipId = w->nextShipId++;
+        req->timestep = t;
+        req->category = 1 + rand_r(&w->rng) % w->maxCategory;  // every ship fits some dock
+        req->direction = rand_r(&w->rng) % 3 ? 1 : -1;
+        req->emergency = req->direction == 1 && rand_r(&w->rng) % 6 == 0;
+        req->waitingTime = 2 + rand_r(&w->rng) % 6;
+        req->numCargo = 1 + rand_r(&w->rng) % 8;
+        for (int j = 0; j < req->numCargo; j++) {
+            req->cargo[j] = 1 + rand_r(&w->rng) % w->liftLimit[req->category];
+        }
+    }
+    // ships whose waiting time ran out come back a third of the time
+    for (int i = 0; i < port->nships && k < MAX_NEW_REQUESTS; i++) {
+        Ship *ship = &port->ships[i];
+        if (ship->status != 0 || ship->direction != 1 || ship->emergency != 0 || ship->wheelSlot != WHEEL_NONE
+            || rand_r(&w->rng) % 3 != 0) {
+            continue;
+        }
+        ShipRequest *req = &out[k++];
+        req->shipId = ship->id;
+        req->timestep = t;
+        req->category = ship->category;
+        req->direction = ship->direction;
+        req->emergency = ship->emergency;
+        req->waitingTime = ship->waitingTime;
+        req->numCargo = ship->numCargo;
+        memcpy(req->cargo, ship->cargo, ship->numCargo * sizeof(int));
+    }
+    return k;
+}
+
+// run one policy over the whole workload and print its row
+void evaluate(Workload *w, const SchedPolicy *policy, int reserve) {
+    Port *port = port_open_offline(w->docks, w->n, w->m, policy, &evalMemory);
+    port->authSeed = w->seed;
+    port->reserve = reserve;
+    port->reserveHorizon = reserveHorizon;
+    Arena stepArena;
+    arena_init(&stepArena, SOLVER_ARENA_SIZE);  // offline timesteps don't allocate
+    port->stepArena = &stepArena;
+    w->next = 0;
+    w->rng = w->seed;
+    w->nextShipId = 0;
+
+    MessageStruct m;
+    memset(&m, 0, sizeof(m));
+    m.mtype = 1;
+    long long start = now_ns();
+    for (int t = 1; ; t++) {
+        m.timestep = t;
+        m.isFinished = t >= w->endTimestep;
+        m.numShipRequests = m.isFinished ? 0 : workload_step(w, port, t);
+        if (run_timestep(port, &m)) {
             break;
         }
-        // here we are handling ship requests
-        //printf("Handling ship requests! ");
-        //printf("debug:Calling new_ship_req function!")
-        new_ship_req(m.numShipRequests);
-        qsort(ships, nships, sizeof(Ship), cmp_ships);
-        int num_free_docks, emergencyShipCount;
-        cnt_available_docks(&num_free_docks, &emergencyShipCount);
-       
-        process_emg_ships();
-        process_reg_ships();  
-        process_out_ships();
-        process_Docks();
-        timestep_inc();
     }
-    //shared memory cleanup
-    if(shmdt(sharedMemory) == -1){
-        perror("error detaching shared memory\n");
+    double elapsed = (now_ns() - start) / 1e9;
+    int steps = w->endTimestep - 1;
+
+    char label[32];
+    if (reserve) {
+        snprintf(label, sizeof(label), "%s+r%d", policy->name, reserve);
+    } else {
+        snprintf(label, sizeof(label), "%s", policy->name);
+    }
+    printf("%-13s %9.0f %7lld %8.2f %8.2f %8lld %10.2f %5d %5d %14lld", label, steps / elapsed,
+           port->shipsServed, 100.0 * port->shipsServed / steps, 100.0 * port->regularServed / steps,
+           port->deadlineMisses, port->shipsServed ? (double)port->turnaroundSum / port->shipsServed : 0.0,
+           emg_wait_percentile(port, 0.5), emg_wait_percentile(port, 0.99), port->authGuesses);
+    if (port->shipsDropped) {
+        printf(" | overloaded, %lld ships dropped", port->shipsDropped);
+    }
+    printf("\n");
+    arena_destroy(&stepArena);
+    port_close(port);
+}
+
+// --evaluate: every --policy (default: all of them) over one workload
+void run_evaluator(const char *spec) {
+    static Workload w;
+    if (strncmp(spec, "gen:", 4) == 0) {
+        char *end;
+        unsigned seed = strtoul(spec + 4, &end, 10);
+        int steps = GEN_DEFAULT_STEPS, load = GEN_DEFAULT_LOAD;
+        if (*end == ',') {
+            steps = strtol(end + 1, &end, 10);
+        }
+        if (*end == ',') {
+            load = strtol(end + 1, &end, 10);
+        }
+        if (*end != '\0' || steps <= 0 || load <= 0 || load > 300) {
+            fprintf(stderr, "bad workload %s\n", spec);
+            exit(EXIT_FAILURE);
+        }
+        workload_generate(&w, seed, steps, load);
+    } else if (workload_load(&w, spec) == -1) {
+        fprintf(stderr, "error reading workload %s\n", spec);
+        exit(EXIT_FAILURE);
+    }
+    if (numPolicies == 0) {
+        while (schedPolicies[numPolicies] && numPolicies < MAX_EVAL_POLICIES) {
+            policies[numPolicies] = schedPolicies[numPolicies];
+            numPolicies++;
+        }
+    }
+
+    printf("workload %s: %d docks, %d solvers, %d timesteps, %s\n", spec, w.n, w.m, w.endTimestep - 1,
+           w.generated ? "generated" : "recorded");
+    printf("%-13s %9s %7s %8s %8s %8s %10s %5s %5s %14s\n", "policy", "steps/s", "served", "/100", "reg/100",
+           "misses", "turnaround", "emg50", "emg99", "auth guesses");
+    for (int i = 0; i < numPolicies; i++) {
+        evaluate(&w, policies[i], 0);
+        if (reserveCount > 0) {
+            evaluate(&w, policies[i], reserveCount);
+        }
+    }
+    free(w.requests);
+}
+
+void print_port_stats(const char *label, const PortTotals *t, int steps, const char *estimated) {
+    printf("  %-7s %6lld served, %6.2f per 100 steps | %6lld deadline misses | turnaround %6.2f"
+           " | emergency wait p50 %d p99 %d | %s%lld auth guesses\n",
+           label, t->shipsServed, 100.0 * t->shipsServed / steps, t->deadlineMisses,
+           t->shipsServed ? (double)t->turnaroundSum / t->shipsServed : 0.0,
+           wait_percentile(t->emgWait, t->emgDocked, 0.5), wait_percentile(t->emgWait, t->emgDocked, 0.99),
+           estimated, t->authGuesses);
+}
+
+// --reserve: what the reservation cost and bought, printed at exit
+void reserve_report(Port *port) {
+    int steps = port->timesteps > 0 ? port->timesteps : 1;
+    printf("testcase %d, %d docks reserved: emergency wait p50 %d p99 %d timesteps over %lld ships"
+           " | %lld regular ships served, %.2f per 100 timesteps | a dock held in %lld timesteps\n",
+           port->tc, port->reserve, emg_wait_percentile(port, 0.5), emg_wait_percentile(port, 0.99),
+           port->emgDocked, port->regularServed, 100.0 * port->regularServed / steps, port->heldSteps);
+}
+
+// --shadow: printed once the run is over
+void shadow_report(Port *port) {
+    Port *shadow = port->shadow;
+    ShadowStats *st = &port->shadowStats;
+    int steps = st->steps > 0 ? st->steps : 1;
+    printf("shadow, testcase %d: policy %s against live %s over %d timesteps\n",
+           port->tc, shadow->policy->name, port->policy->name, st->steps);
+    printf("  dockings differed in %d timesteps, %lld decisions (%lld live dockings, %lld shadow)",
+           st->diffSteps, st->diffDecisions, st->primaryDockings, st->shadowDockings);
+    if (st->diffSteps > 0) {
+        printf(", first at t=%d", st->firstDiff);
+    }
+    printf("\n");
+    if (st->stoppedAt) {
+        printf("  shadow stopped at t=%d, %d timesteps behind the live port; both sides cover the timesteps before\n",
+               st->stoppedAt, SHADOW_QUEUE_STEPS);
+    }
+    // both sides over the timesteps the shadow ran
+    PortTotals live, other;
+    if (st->stoppedAt) {
+        live = st->liveAtStop;
+    } else {
+        port_totals(port, &live);
+    }
+    port_totals(shadow, &other);
+    print_port_stats("live", &live, steps, "");
+    print_port_stats("shadow", &other, steps, "~");
+
+    // Time outside auth searches is taken to be the same under either
+    // policy; the shadow's searches cost what live ones did per guess.
+    double liveSec = (st->primaryNs - st->pathNs) / 1e9;
+    double perGuess = live.authGuesses ? live.authNs / 1e9 / live.authGuesses : 0.0;
+    double shadowSec = liveSec - live.authNs / 1e9 + other.authGuesses * perGuess;
+    if (liveSec > 0 && shadowSec > 0) {
+        printf("  projected: live %.1f ships per second of scheduling, shadow %.1f\n",
+               live.shipsServed / liveSec, other.shipsServed / shadowSec);
+    }
+    if (liveSec > 0) {
+        printf("  shadow cost: %.2f%% of live timestep time on the live thread (request copy),"
+               " %.2f%% on the shadow thread\n",
+               100.0 * st->pathNs / (liveSec * 1e9), 100.0 * st->shadowNs / (liveSec * 1e9));
+    }
+}
+
+// "<count>[,<horizon>]"
+void parse_reserve(const char *arg, int *count, int *horizon) {
+    char *end;
+    *count = strtol(arg, &end, 10);
+    if (*end == ',') {
+        *horizon = strtol(end + 1, &end, 10);
+    }
+    if (*end != '\0' || end == arg || *count < 0 || *count > MAX_DOCKS || *horizon < 1) {
+        fprintf(stderr, "bad reservation %s, expected <docks>[,<horizon_timesteps>]\n", arg);
+        exit(EXIT_FAILURE);
+    }
+}
+
+// "name[,name...]" or "all"
+void parse_policies(const char *arg) {
+    if (strcmp(arg, "all") == 0) {
+        for (numPolicies = 0; schedPolicies[numPolicies] && numPolicies < MAX_EVAL_POLICIES; numPolicies++) {
+            policies[numPolicies] = schedPolicies[numPolicies];
+        }
+        return;
+    }
+    char name[64];
+    while (*arg) {
+        size_t len = strcspn(arg, ",");
+        snprintf(name, sizeof(name), "%.*s", (int)len, arg);
+        const SchedPolicy *policy = policy_find(name);
+        if (!policy || numPolicies == MAX_EVAL_POLICIES) {
+            fprintf(stderr, "unknown policy %s, expected one of:\n", name);
+            for (int i = 0; schedPolicies[i]; i++) {
+                fprintf(stderr, "  %-10s %s\n", schedPolicies[i]->name, schedPolicies[i]->description);
+            }
+            exit(EXIT_FAILURE);
+        }
+        policies[numPolicies++] = policy;
+        arg += len + (arg[len] == ',');
+    }
+}
+
+int main(int argc, char *argv[]) {
+    int tcs[MAX_PORTS];
+    int solverThreads = MAX_SOLVERS;
+    bool metricsOn = false;
+    key_t metricsKey = 0;
+    const char *pinSpec = NULL;
+    const char *evalSpec = NULL;
+    const char *recordPath = NULL;
+    const SchedPolicy *shadowPolicy = NULL;
+
+    for (int i = 1; i < argc; i++) {
+        if (strncmp(argv[i], "--", 2) != 0) {
+            int added = parse_testcases(argv[i], tcs, numPorts);
+            if (added == -1) {
+                fprintf(stderr, "bad testcase %s\n", argv[i]);
+                exit(EXIT_FAILURE);
+            }
+            if (added == -2) {
+                fprintf(stderr, "too many testcases at %s: at most %d ports per process\n", argv[i], MAX_PORTS);
+                exit(EXIT_FAILURE);
+            }
+            numPorts += added;
+        } else if (strncmp(argv[i], "--ipc=", 6) == 0) {
+            ipcKind = parse_ipc_kind(argv[i] + 6);
+            if (ipcKind == -1) {
+                fprintf(stderr, "unknown ipc backend %s (expected sysv or ring)\n", argv[i] + 6);
+                exit(EXIT_FAILURE);
+            }
+        } else if (strncmp(argv[i], "--auth-model=", 13) == 0) {
+            authModelPath = argv[i] + 13;
+            int entries = auth_model_load(&authModel, authModelPath);
+            authModelLog = auth_model_open_log(authModelPath);
+            if (authModelLog == NULL) {
+                perror("error opening auth model history");
+                exit(EXIT_FAILURE);
+            }
+            printf("auth learning mode, %d saved auth strings loaded\n", entries < 0 ? 0 : entries);
+        } else if (strncmp(argv[i], "--metrics=", 10) == 0) {
+            metricsOn = true;
+            metricsKey = (key_t)strtol(argv[i] + 10, NULL, 0);
+        } else if (strncmp(argv[i], "--alloc-check=", 14) == 0) {
+#ifndef ALLOC_CHECK
+            fprintf(stderr, "--alloc-check needs a build with -DALLOC_CHECK and alloc_guard.c\n");
+            exit(EXIT_FAILURE);
+#endif
+            allocCheckWarmup = atoi(argv[i] + 14);
+        } else if (strncmp(argv[i], "--workers=", 10) == 0) {
+            portWorkers = atoi(argv[i] + 10);
+        } else if (strncmp(argv[i], "--solver-threads=", 17) == 0) {
+            solverThreads = atoi(argv[i] + 17);
+        } else if (strncmp(argv[i], "--pin=", 6) == 0) {
+            pinSpec = argv[i] + 6;
+        } else if (strncmp(argv[i], "--busy-poll=", 12) == 0) {
+            transport_set_busy_poll(atoi(argv[i] + 12));
+        } else if (strncmp(argv[i], "--policy=", 9) == 0) {
+            parse_policies(argv[i] + 9);
+        } else if (strncmp(argv[i], "--evaluate=", 11) == 0) {
+            evalSpec = argv[i] + 11;
+        } else if (strncmp(argv[i], "--record=", 9) == 0) {
+            recordPath = argv[i] + 9;
+        } else if (strncmp(argv[i], "--shadow=", 9) == 0) {
+            shadowPolicy = policy_find(argv[i] + 9);
+            if (!shadowPolicy) {
+                fprintf(stderr, "unknown policy %s\n", argv[i] + 9);
+                exit(EXIT_FAILURE);
+            }
+        } else if (strncmp(argv[i], "--reserve=", 10) == 0) {
+            parse_reserve(argv[i] + 10, &reserveCount, &reserveHorizon);
+        } else if (strncmp(argv[i], "--shadow-reserve=", 17) == 0) {
+            parse_reserve(argv[i] + 17, &shadowReserve, &shadowReserveHorizon);
+        } else if (strncmp(argv[i], "--shadow-diff=", 14) == 0) {
+            // the stdio buffer is static so writing never touches the heap
+            static char diffBuf[BUFSIZ];
+            shadowDiffFile = fopen(argv[i] + 14, "w");
+            if (shadowDiffFile == NULL) {
+                perror("error opening shadow diff file");
+                exit(EXIT_FAILURE);
+            }
+            setvbuf(shadowDiffFile, diffBuf, _IOFBF, sizeof(diffBuf));
+        } else {
+            fprintf(stderr, "unknown option %s\n", argv[i]);
+            exit(EXIT_FAILURE);
+        }
+    }
+    if (evalSpec) {
+        run_evaluator(evalSpec);
+        return 0;
+    }
+    if(numPorts == 0){
+        fprintf(stderr, "invalid usage , format is %s <testcase_number>... [--ipc=sysv|ring] [--auth-model=<file>] [--metrics=<shm_key>]"
+                " [--alloc-check=<warmup_steps>] [--workers=<n>] [--solver-threads=<n>] [--pin=auto|<cpu_list>]"
+                " [--busy-poll=<spins>] [--policy=<name>] [--record=<file>] [--shadow=<policy>]"
+                " [--shadow-diff=<file>] [--reserve=<docks>[,<horizon>]] [--shadow-reserve=<docks>[,<horizon>]]\n"
+                "       %s --evaluate=<workload_file>|gen:<seed>[,<steps>[,<ships_per_100_steps>]] [--policy=<name>[,<name>...]|all]"
+                " [--reserve=<docks>[,<horizon>]]\n",
+                argv[0], argv[0]);
+        exit(EXIT_FAILURE);
+    }
+    if (numPolicies > 1) {
+        fprintf(stderr, "a live run takes one --policy\n");
+        exit(EXIT_FAILURE);
+    }
+    if (numPolicies == 0) {
+        policies[numPolicies++] = schedPolicies[0];
+    }
+    if (recordPath && numPorts > 1) {
+        fprintf(stderr, "--record takes a single testcase\n");
+        exit(EXIT_FAILURE);
+    }
+
+    printf(" taken input is : %d,",tcs[0]);
+    srand(time(NULL));  
+    // a fixed threshold keeps every arena block on its own mapping; glibc's
+    // adaptive one would move them into the heap, where freed blocks stay
+    // resident
+    mallopt(M_MMAP_THRESHOLD, STEP_ARENA_SIZE);
+   
+    for (int i = 0; i < numPorts; i++) {
+        ports[i] = port_open(tcs[i]);
+        if (metricsOn) {
+            open_metrics(ports[i], metricsKey + i);  // one page per port
+        }
+        if (shadowPolicy) {
+            shadow_open(ports[i], shadowPolicy);
+        }
+    }
+    printf("taken input successfully! \n");
+    if (shadowPolicy) {
+        shadow_start();
+    }
+
+    if (numPorts > 1) {
+        if (portWorkers <= 0) {
+            portWorkers = DEFAULT_PORT_WORKERS;
+        }
+        portWorkers = portWorkers < numPorts ? portWorkers : numPorts;
+        portWorkers = portWorkers < MAX_POOL_THREADS ? portWorkers : MAX_POOL_THREADS;
+        solverThreads = solverThreads < 1 ? 1 : solverThreads < MAX_POOL_THREADS ? solverThreads : MAX_POOL_THREADS;
+    }
+    if (pinSpec) {
+        if (numPorts == 1) {
+            setup_pinning(pinSpec, 1, ports[0]->m);
+        } else {
+            setup_pinning(pinSpec, portWorkers, solverThreads);
+        }
+    }
+
+    printf("scheduling starting... \n");
+    if (numPorts == 1) {
+        Port *port = ports[0];
+        if (pinning) {
+            pin_port(port);
+        }
+        MessageStruct m;
+        Arena stepArena;
+        arena_init(&stepArena, STEP_ARENA_SIZE);
+        port->stepArena = &stepArena;
+        if (recordPath) {
+            recordFile = fopen(recordPath, "w");
+            if (recordFile == NULL) {
+                perror("error opening workload record");
+                exit(EXIT_FAILURE);
+            }
+            record_docks(recordFile, port);
+        }
+        bool all_ships_done = false;
+         while (!all_ships_done) {
+             if (transport_recv(&port->mainQueue, &m, sizeof(MessageStruct) - sizeof(long), 1) == -1) {
+                perror("Error in receiving messages from validation!!! ");
+                exit(EXIT_FAILURE);
+            }
+            port->ipcMainRecv++;
+            if (recordFile) {
+                record_step(recordFile, port, &m);
+            }
+            all_ships_done = run_timestep(port, &m);
+        }
+        if (recordFile) {
+            fclose(recordFile);
+        }
+        printf("done with all ships ...  exiting\n ");
+        arena_destroy(&stepArena);
+        if (pinning) {
+            for (int i = 0; i < port->m; i++) {
+                pthread_attr_destroy(&solverAttr[i]);
+            }
+        }
+    } else {
+        solver_pool_start(&solverPool, solverThreads, pinning ? pinPlan + portWorkers : NULL);
+
+        pthread_t workers[MAX_POOL_THREADS];
+        atomic_store(&portsLeft, numPorts);
+        for (int i = 0; i < portWorkers; i++) {
+            pthread_attr_t attr;
+            pthread_attr_init(&attr);
+            if (pinning) {
+                pin_attr(&attr, pinPlan[i]);
+            }
+            pthread_create(&workers[i], &attr, port_worker, (void *)(intptr_t)(i * numPorts / portWorkers));
+            pthread_attr_destroy(&attr);
+        }
+        for (int i = 0; i < portWorkers; i++) {
+            pthread_join(workers[i], NULL);
+        }
+        solver_pool_stop(&solverPool);
+    }
+    if (shadowPolicy) {
+        shadow_stop();
+    }
+
+    long long authSearches = 0, authGuesses = 0;
+    for (int i = 0; i < numPorts; i++) {
+        authSearches += ports[i]->authSearches;
+        authGuesses += ports[i]->authGuesses;
+    }
+    if (authModelPath) {
+        printf("auth: %lld searches, %lld guesses\n", authSearches, authGuesses);
+        fclose(authModelLog);
+    }
+    alloc_guard_disarm();
+    if (numPorts > 1) {
+        report_host_usage(solverThreads);
+    }
+    for (int i = 0; i < numPorts; i++) {
+        if (ports[i]->reserve > 0) {
+            reserve_report(ports[i]);
+        }
+        if (ports[i]->shadow) {
+            shadow_report(ports[i]);
+        }
+    }
+    if (shadowPolicy) {
+        struct rusage ru;
+        getrusage(RUSAGE_SELF, &ru);
+        long long processNs = (ru.ru_utime.tv_sec + ru.ru_stime.tv_sec) * 1000000000LL
+                              + (ru.ru_utime.tv_usec + ru.ru_stime.tv_usec) * 1000LL;
+        printf("shadow thread: %.3f s cpu, %.2f%% of the process's\n", shadowCpuNs / 1e9,
+               processNs > 0 ? 100.0 * shadowCpuNs / processNs : 0.0);
+    }
+    if (shadowDiffFile) {
+        fclose(shadowDiffFile);
+    }
+    for (int i = 0; i < numPorts; i++) {
+        port_close(ports[i]);
     }
     return 0;
 }
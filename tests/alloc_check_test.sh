@@ -0,0 +1,47 @@
+#!/bin/sh
+# Runs an --alloc-check build of the scheduler against port_standin: single
+# port on both transports, with the auth model and a shadow policy, and
+# several ports in one process. Fails if a run allocates on the scheduling
+# path after warmup or port_standin sees a broken rule.
+# usage: tests/alloc_check_test.sh <build_dir>   (from the repository root)
+set -e
+out=$1
+src=$(pwd)
+S="scheduler.c ipc_transport.c crane_select.c auth_model.c arena.c cpu_topology.c sched_policy.c"
+gcc -O2 -DALLOC_CHECK -o "$out/scheduler_alloc_check" $S alloc_guard.c -lpthread -lm
+gcc -O2 -Wall -o "$out/port_standin" port_standin.c ipc_transport.c
+
+run=$(mktemp -d)
+trap 'rm -rf "$run"' EXIT
+cd "$run"
+
+# Each testcase is its own seed, so the runs see auth strings after warmup
+# longer than any before it; the search must not need more memory for them.
+# port <testcases> <scheduler args...>: one stand-in per testcase, then the scheduler
+port() {
+    cases=$1
+    shift
+    pids=
+    for tc in $cases; do
+        "$out/port_standin" "$tc" 80 2 "$tc" "$ipc" > "standin_$tc.log" 2>&1 &
+        pids="$pids $!"
+    done
+    sleep 0.3
+    if ! "$out/scheduler_alloc_check" $cases "$ipc" --alloc-check=20 "$@" > scheduler.log 2>&1; then
+        cat scheduler.log
+        kill $pids 2> /dev/null || true
+        exit 1
+    fi
+    for pid in $pids; do
+        wait "$pid" || { cat standin_*.log; exit 1; }
+    done
+    echo "alloc check $ipc $cases $*: ok"
+}
+
+ipc=--ipc=sysv
+port 81
+port 82 --auth-model="$run/auth.txt" --shadow=sjf --shadow-diff="$run/diff.txt"
+port "71 72 73" --workers=2 --solver-threads=2
+ipc=--ipc=ring
+port 81
+port "74 75 76" --workers=2 --solver-threads=2
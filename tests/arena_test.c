@@ -0,0 +1,89 @@
+// Arena allocation patterns of the scheduler's timesteps: growing steps,
+// auth tables released by mark, several blocks live at reset, trims between
+// steps. The malloc guard checks that no reset ever touches the heap, even
+// during warmup, and that nothing does once warmup is over. Every
+// allocation must keep what was written to it.
+//
+// build: gcc -O2 -o arena_test tests/arena_test.c arena.c alloc_guard.c
+// usage: ./arena_test
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../arena.h"
+#include "../alloc_guard.h"
+
+#define STEPS 2000
+#define WARMUP 200
+#define MAX_LIVE 64
+
+static long failures;
+
+// one timestep: a few small allocations, then an auth-table-sized one that
+// is released again, like guess_authString, and some results kept
+static void step(Arena *a, unsigned *rng, size_t tableMax) {
+    char *live[MAX_LIVE];
+    size_t sizes[MAX_LIVE];
+    int n = 0;
+    int searches = rand_r(rng) % 4;
+    for (int s = 0; s < searches; s++) {
+        // the result outlives the search, the table does not
+        if (n < MAX_LIVE) {
+            sizes[n] = 1 + rand_r(rng) % 200;
+            live[n] = arena_alloc(a, sizes[n]);
+            memset(live[n], n, sizes[n]);
+            n++;
+        }
+        ArenaMark mark = arena_mark(a);
+        size_t table = 1 + rand_r(rng) % tableMax;
+        char *t = arena_alloc(a, table);
+        memset(t, 0xab, table);
+        if (t[table - 1] != (char)0xab) {
+            failures++;
+        }
+        arena_release(a, mark);
+    }
+    for (int i = 0; i < 8 && n < MAX_LIVE; i++) {
+        sizes[n] = 1 + rand_r(rng) % 4096;
+        live[n] = arena_alloc(a, sizes[n]);
+        memset(live[n], n, sizes[n]);
+        n++;
+    }
+    for (int i = 0; i < n; i++) {
+        for (size_t j = 0; j < sizes[i]; j++) {
+            if (live[i][j] != (char)i) {
+                failures++;
+                break;
+            }
+        }
+    }
+}
+
+int main() {
+    unsigned rng = 99;
+    Arena a;
+    arena_init(&a, 4096);   // far too small, so warmup chains several blocks
+    long resetAllocs = 0;
+    long steadyAllocs = 0;
+    for (int t = 0; t < STEPS; t++) {
+        if (t >= WARMUP) {
+            alloc_guard_arm();
+        }
+        // the biggest table shows up during warmup, so later steps never exceed it
+        step(&a, &rng, t == WARMUP / 2 ? (1 << 22) : (1 << 20));
+        if (t % 3 == 0) {
+            arena_trim(&a, 8192);
+        }
+        if (t >= WARMUP) {
+            steadyAllocs += alloc_guard_count();
+        }
+        alloc_guard_arm();
+        arena_reset(&a);
+        resetAllocs += alloc_guard_count();
+        alloc_guard_disarm();
+    }
+    printf("arena: %d timesteps, %zu bytes in blocks, high water %zu, %ld heap allocations in resets,"
+           " %ld after warmup, %ld corrupted allocations\n",
+           STEPS, a.capacity, a.highWater, resetAllocs, steadyAllocs, failures);
+    arena_destroy(&a);
+    return resetAllocs > 0 || steadyAllocs > 0 || failures > 0 ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,163 @@
+// auth_model_top against a full scan of the candidate space: for models
+// trained on random histories, the k best candidates (score, then lowest
+// index) must come back in the same order for every length small enough
+// to scan. Long lengths, which can't be scanned, are only timed. The
+// search order the solver workers walk must visit every candidate once,
+// the likely ones first and then the rest in plain order, whichever
+// stride a worker takes, and spell each so auth_plain_index reads it back.
+//
+// build: gcc -O2 -o auth_model_test tests/auth_model_test.c auth_model.c -lm
+// usage: ./auth_model_test
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "../auth_model.h"
+
+#define SCAN_MAX_LEN 7
+
+typedef struct Scored {
+    long long score;
+    long long idx;
+} Scored;
+
+static AuthModel model;
+static Scored all[5 * 6 * 6 * 6 * 6 * 6 * 5];
+static long long top[AUTH_PROBE_LIMIT];
+static long long walk[5 * 6 * 6 * 6 * 6 * 6 * 5];
+static char seen[5 * 6 * 6 * 6 * 6 * 6 * 5];
+static AuthOrder order;
+
+static int by_rank(const void *a, const void *b) {
+    const Scored *x = a, *y = b;
+    if (x->score != y->score) {
+        return x->score > y->score ? -1 : 1;
+    }
+    return (x->idx > y->idx) - (x->idx < y->idx);
+}
+
+// auth strings leaning towards a few characters, like real histories do
+static void random_auth(unsigned *rng, int length, int skew, char *out) {
+    const char *mid = "56789.", *end = "56789";
+    for (int i = 0; i < length; i++) {
+        int alphabet = i == 0 || i == length - 1 ? 5 : 6;
+        int c = rand_r(rng) % skew == 0 ? (int)(rand_r(rng) % alphabet) : (i * 7 + length) % alphabet;
+        out[i] = alphabet == 5 ? end[c] : mid[c];
+    }
+    out[length] = '\0';
+}
+
+static double now_sec() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+int main() {
+    static const int histories[] = { 1, 2, 5, 40, 400 };
+    static const int limits[] = { 1, 7, 100, AUTH_PROBE_LIMIT };
+    unsigned rng = 7;
+    long checks = 0, failures = 0;
+    char auth[AUTH_MODEL_MAX_LEN + 1];
+
+    for (size_t h = 0; h < sizeof(histories) / sizeof(histories[0]); h++) {
+        memset(&model, 0, sizeof(model));
+        for (int i = 0; i < histories[h]; i++) {
+            int length = 1 + rand_r(&rng) % AUTH_MODEL_MAX_LEN;
+            random_auth(&rng, length, 2 + (int)h, auth);
+            auth_model_record(&model, rand_r(&rng) % 4, auth);
+        }
+        for (int length = 1; length <= SCAN_MAX_LEN; length++) {
+            if (model.samples[length] == 0) {
+                random_auth(&rng, length, 3, auth);
+                auth_model_record(&model, 0, auth);
+            }
+            for (int dockId = 0; dockId < 3; dockId++) {
+                long long total = auth_space_size(length);
+                for (long long idx = 0; idx < total; idx++) {
+                    all[idx] = (Scored){ auth_model_score(&model, dockId, length, idx), idx };
+                }
+                qsort(all, total, sizeof(Scored), by_rank);
+                for (size_t l = 0; l < sizeof(limits) / sizeof(limits[0]); l++) {
+                    int k = auth_model_top(&model, dockId, length, top, limits[l]);
+                    int want = total < limits[l] ? (int)total : limits[l];
+                    checks++;
+                    int bad = k != want;
+                    for (int i = 0; !bad && i < k; i++) {
+                        bad = top[i] != all[i].idx;
+                    }
+                    if (bad && failures++ < 10) {
+                        fprintf(stderr, "mismatch: history %d, length %d, dock %d, limit %d (%d returned)\n",
+                                histories[h], length, dockId, limits[l], k);
+                    }
+                }
+            }
+        }
+    }
+
+    // too many candidates to scan; the search must not care
+    double worst = 0;
+    for (int length = SCAN_MAX_LEN + 1; length <= AUTH_MODEL_MAX_LEN; length++) {
+        random_auth(&rng, length, 3, auth);
+        auth_model_record(&model, 1, auth);
+        double start = now_sec();
+        int k = auth_model_top(&model, 1, length, top, AUTH_PROBE_LIMIT);
+        double elapsed = now_sec() - start;
+        worst = elapsed > worst ? elapsed : worst;
+        checks++;
+        for (int i = 1; i < k; i++) {
+            long long a = auth_model_score(&model, 1, length, top[i - 1]);
+            long long b = auth_model_score(&model, 1, length, top[i]);
+            if (k != AUTH_PROBE_LIMIT || a < b || (a == b && top[i - 1] >= top[i])) {
+                fprintf(stderr, "length %d: top %d not in rank order at %d\n", length, k, i);
+                failures++;
+                break;
+            }
+        }
+    }
+
+    long orderChecks = 0, orderFailures = 0;
+    for (int length = 1; length <= SCAN_MAX_LEN; length++) {
+        for (int learned = 0; learned < 2; learned++) {
+            auth_order_init(&order, learned ? &model : NULL, 2, length);
+            int bad = order.total != auth_space_size(length) || (learned && order.numTop == 0);
+            memset(seen, 0, order.total);
+            int skipped = 0;
+            long long plainNext = 0;
+            for (long long pos = 0; !bad && pos < order.total; pos++) {
+                long long idx = auth_order_at(&order, pos, &skipped);
+                walk[pos] = idx;
+                bad = idx < 0 || idx >= order.total || seen[idx];
+                if (!bad && pos < order.numTop) {
+                    bad = idx != order.top[pos];
+                } else if (!bad) {
+                    bad = idx < plainNext;
+                    plainNext = idx + 1;
+                }
+                if (!bad) {
+                    seen[idx] = 1;
+                    auth_plain_string(length, idx, auth);
+                    bad = (long long)strlen(auth) != length || auth_plain_index(auth) != idx;
+                }
+            }
+            for (int stride = 2; !bad && stride <= 5; stride++) {
+                for (int start = 0; !bad && start < stride; start++) {
+                    skipped = 0;
+                    for (long long pos = start; !bad && pos < order.total; pos += stride) {
+                        bad = auth_order_at(&order, pos, &skipped) != walk[pos];
+                    }
+                }
+            }
+            orderChecks++;
+            if (bad && orderFailures++ < 10) {
+                fprintf(stderr, "search order wrong: length %d, %s\n", length, learned ? "learned" : "plain");
+            }
+        }
+    }
+    failures += orderFailures;
+
+    printf("auth_model_top: %ld checks, %ld failures, slowest long search %.2f ms\n", checks, failures - orderFailures,
+           worst * 1e3);
+    printf("auth_order: %ld orders walked, %ld wrong\n", orderChecks, orderFailures);
+    return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,86 @@
+// Thread placement as --pin does it: a plan from the host's topology for a
+// main loop and solver workers, then one thread per planned cpu, started
+// with pin_attr (solver queue workers) or moved with pin_thread (the main
+// loop). Each must end up with exactly its planned cpu in its affinity;
+// the scheduler itself doesn't check this at run time.
+// Also checks parse_cpu_list on a few lists.
+//
+// build: gcc -O2 -o cpu_topology_test tests/cpu_topology_test.c cpu_topology.c -lpthread
+// usage: ./cpu_topology_test
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <pthread.h>
+#include "../cpu_topology.h"
+
+#define PLANNED 9   // main loop and 8 solver queues, more than most test hosts have
+
+static CpuTopology topology;
+static long failures;
+
+static void *check_self(void *arg) {
+    int cpu = *(int *)arg;
+    if (pinned_to(pthread_self(), cpu) != 1) {
+        fprintf(stderr, "thread started pinned to cpu %d runs elsewhere\n", cpu);
+        failures++;
+    }
+    return NULL;
+}
+
+static void check_list(const char *list, const int *want, int count) {
+    int cpus[16];
+    int got = parse_cpu_list(list, cpus, 16);
+    if (got != count || (count > 0 && memcmp(cpus, want, count * sizeof(int)) != 0)) {
+        fprintf(stderr, "parse_cpu_list(\"%s\") returned %d cpus, wanted %d\n", list, got, count);
+        failures++;
+    }
+}
+
+int main() {
+    if (topology_load(&topology) < 1) {
+        fprintf(stderr, "no usable cpus in the topology\n");
+        return EXIT_FAILURE;
+    }
+    int plan[PLANNED];
+    topology_plan(&topology, plan, PLANNED);
+
+    for (int i = 0; i < PLANNED; i++) {
+        bool known = false;
+        for (int c = 0; c < topology.numCpus; c++) {
+            known = known || topology.cpus[c].cpu == plan[i];
+        }
+        if (!known) {
+            fprintf(stderr, "plan[%d] is cpu %d, not one this process may use\n", i, plan[i]);
+            failures++;
+            continue;
+        }
+
+        if (i == 0) {
+            // the main loop pins itself, before any worker starts
+            int err = pin_thread(pthread_self(), plan[i]);
+            if (err || pinned_to(pthread_self(), plan[i]) != 1) {
+                fprintf(stderr, "pin_thread to cpu %d: %s\n", plan[i], err ? strerror(err) : "not applied");
+                failures++;
+            }
+            continue;
+        }
+        pthread_t thread;
+        pthread_attr_t attr;
+        pthread_attr_init(&attr);
+        pin_attr(&attr, plan[i]);
+        pthread_create(&thread, &attr, check_self, &plan[i]);
+        pthread_attr_destroy(&attr);
+        pthread_join(thread, NULL);
+    }
+
+    check_list("3", (int[]){ 3 }, 1);
+    check_list("0-3,8,10-11", (int[]){ 0, 1, 2, 3, 8, 10, 11 }, 7);
+    check_list("2,x", NULL, -1);
+    check_list("5-2", NULL, -1);
+
+    printf("cpu_topology: %d cpus on %d nodes, %d planned threads placed, %ld failures\n", topology.numCpus,
+           topology.numNodes, PLANNED, failures);
+    return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,107 @@
+// Every crane selection kernel against the scan load_cargo/unload_cargo
+// did before crane_select.c: same crane, or -1, for random docks with
+// 0-25 cranes, some of them used, garbage in the padding lanes, and
+// capacities up to INT_MAX. Weights are cargo weights, so at least 1.
+//
+// build: gcc -O2 -o crane_select_test tests/crane_select_test.c crane_select.c
+// usage: ./crane_select_test [iterations]
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <limits.h>
+#include "../crane_select.h"
+
+#define MAX_CATEGORY 25
+
+// the loop from load_cargo, as it was
+static int old_scan(const int *craneCapacities, const bool *craneUsed, int numCranes, int cargoWeight) {
+    int bestCraneIdx = -1;
+    int minWaste = INT_MAX;
+    int craneidx = 0;
+    while (craneidx < numCranes) {
+        if (!craneUsed[craneidx] && craneCapacities[craneidx] >= cargoWeight) {
+            int waste = craneCapacities[craneidx] - cargoWeight;
+            if (waste < minWaste) {
+                minWaste = waste;
+                bestCraneIdx = craneidx;
+            }
+        }
+        craneidx++;
+    }
+    return bestCraneIdx;
+}
+
+static int random_capacity(unsigned *rng) {
+    switch (rand_r(rng) % 8) {
+    case 0:
+        return INT_MAX;
+    case 1:
+        return INT_MAX - rand_r(rng) % 4;
+    case 2:
+        return rand_r(rng) % 3;       // cranes that lift nothing or next to nothing
+    default:
+        return 1 + rand_r(rng) % 50;  // small range, so ties are common
+    }
+}
+
+static int random_weight(unsigned *rng) {
+    switch (rand_r(rng) % 8) {
+    case 0:
+        return INT_MAX - rand_r(rng) % 4;
+    case 1:
+        return 1;
+    default:
+        return 1 + rand_r(rng) % 60;
+    }
+}
+
+int main(int argc, char *argv[]) {
+    long iterations = argc > 1 ? atol(argv[1]) : 2000000;
+    unsigned rng = 12345;
+    bool sse4 = false, avx2 = false;
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_cpu_init();
+    sse4 = __builtin_cpu_supports("sse4.1");
+    avx2 = __builtin_cpu_supports("avx2");
+#endif
+    long mismatches = 0;
+    for (long it = 0; it < iterations; it++) {
+        CraneSet cs;
+        int capacities[MAX_CATEGORY];
+        bool used[MAX_CATEGORY];
+        int numCranes = rand_r(&rng) % (MAX_CATEGORY + 1);
+        for (int i = 0; i < CRANE_LANES; i++) {
+            cs.capacity[i] = random_capacity(&rng);  // padding lanes keep theirs
+        }
+        crane_set_reset(&cs, numCranes);
+        for (int i = 0; i < numCranes; i++) {
+            capacities[i] = cs.capacity[i];
+            used[i] = rand_r(&rng) % 3 == 0;
+            if (used[i]) {
+                crane_set_use(&cs, i);
+            }
+        }
+        int weight = random_weight(&rng);
+
+        int want = old_scan(capacities, used, numCranes, weight);
+        int got[4] = { crane_select_scalar(&cs, weight), crane_select_best(&cs, weight), want, want };
+#if defined(__x86_64__) || defined(__i386__)
+        if (sse4) {
+            got[2] = crane_select_sse4(&cs, weight);
+        }
+        if (avx2) {
+            got[3] = crane_select_avx2(&cs, weight);
+        }
+#endif
+        for (int k = 0; k < 4; k++) {
+            if (got[k] != want && mismatches++ < 10) {
+                static const char *names[] = { "scalar", "dispatched", "sse4.1", "avx2" };
+                fprintf(stderr, "mismatch: %s picked %d, old scan %d (weight %d, %d cranes)\n", names[k], got[k],
+                        want, weight, numCranes);
+            }
+        }
+    }
+    printf("crane_select: %ld cases, kernels scalar%s%s (dispatching to %s), %ld mismatches\n", iterations,
+           sse4 ? " sse4.1" : "", avx2 ? " avx2" : "", crane_select_name(), mismatches);
+    return mismatches ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,42 @@
+#!/bin/sh
+# Checks --evaluate's numbers two ways. A live run against port_standin is
+# recorded and replayed offline with the same policy: the replay has to
+# serve exactly the ships validation saw served. Generated workloads have
+# to keep every policy's throughput near the offered load with nothing
+# dropped, which a dock held forever by unliftable cargo would break.
+# usage: tests/evaluator_test.sh <build_dir>   (from the repository root)
+set -e
+out=$1
+S="scheduler.c ipc_transport.c crane_select.c auth_model.c arena.c cpu_topology.c sched_policy.c"
+gcc -O2 -o "$out/scheduler" $S -lpthread -lm
+gcc -O2 -Wall -o "$out/port_standin" port_standin.c ipc_transport.c
+
+run=$(mktemp -d)
+trap 'rm -rf "$run"' EXIT
+cd "$run"
+
+for args in "81 60 2 5" "83 80 3 7" "85 60 2 11"; do
+    set -- $args
+    "$out/port_standin" $args > standin.log 2>&1 &
+    sp=$!
+    sleep 0.3
+    "$out/scheduler" "$1" --record="$run/rec_$1.txt" > scheduler.log 2>&1
+    wait $sp || { cat standin.log; exit 1; }
+    live=$(sed -n 's/.* ships, \([0-9]*\) served,.*/\1/p' standin.log)
+    replay=$("$out/scheduler" --evaluate="$run/rec_$1.txt" --policy=default | awk '$1 == "default" { print $3 }')
+    if [ "$live" != "$replay" ]; then
+        echo "evaluator: testcase $1 replay served $replay ships, validation saw $live"
+        exit 1
+    fi
+    echo "evaluator: testcase $1 replay served $replay ships, as validation saw"
+done
+
+# generated workloads offer 80 new ships per 100 timesteps; every policy
+# serves nearly all of them, a dock stuck on unliftable cargo a fraction
+for seed in 1 2 3; do
+    "$out/scheduler" --evaluate=gen:$seed,2000 --policy=all > eval.txt
+    awk -v seed=$seed '
+        NR > 2 && ($4 < 70 || /overloaded/) { print "evaluator: gen:" seed " " $0; bad = 1 }
+        END { exit bad }' eval.txt || exit 1
+    echo "evaluator: gen:$seed,2000 every policy above 70 served per 100 steps"
+done
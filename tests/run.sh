@@ -0,0 +1,24 @@
+#!/bin/sh
+# Builds and runs the tests from the repository root: ./tests/run.sh
+set -e
+cd "$(dirname "$0")/.."
+out=${TEST_BUILD_DIR:-/tmp/port_tests}
+mkdir -p "$out"
+
+gcc -O2 -Wall -o "$out/crane_select_test" tests/crane_select_test.c crane_select.c
+"$out/crane_select_test"
+
+gcc -O2 -Wall -o "$out/auth_model_test" tests/auth_model_test.c auth_model.c -lm
+"$out/auth_model_test"
+
+gcc -O2 -Wall -o "$out/arena_test" tests/arena_test.c arena.c alloc_guard.c
+"$out/arena_test"
+
+gcc -O2 -Wall -o "$out/cpu_topology_test" tests/cpu_topology_test.c cpu_topology.c -lpthread
+"$out/cpu_topology_test"
+
+tests/alloc_check_test.sh "$out"
+
+tests/evaluator_test.sh "$out"
+
+echo "all tests passed"